@@ -0,0 +1,217 @@
+#include "ActorRegistry.h"
+
+#include "../IBaseApi.h"
+#include <IApiUtils.h>
+#include <IHooks.h>
+
+namespace AsaApi
+{
+	DECLARE_HOOK(AActor_DispatchBeginPlay, void, AActor*, bool);
+	DECLARE_HOOK(AActor_RouteEndPlay, void, AActor*, EEndPlayReason::Type);
+
+	void Hook_AActor_DispatchBeginPlay(AActor* _this, bool bFromLevelStreaming)
+	{
+		AActor_DispatchBeginPlay_original(_this, bFromLevelStreaming);
+		ActorRegistry::Get().OnBeginPlay(_this);
+	}
+
+	void Hook_AActor_RouteEndPlay(AActor* _this, EEndPlayReason::Type EndPlayReason)
+	{
+		ActorRegistry::Get().OnEndPlay(_this);
+		AActor_RouteEndPlay_original(_this, EndPlayReason);
+	}
+
+	// ActorSet
+
+	void ActorRegistry::ActorSet::Add(AActor* actor)
+	{
+		const auto [iter, inserted] = positions.try_emplace(actor, actors.size());
+		if (inserted)
+		{
+			actors.emplace_back(actor);
+			return;
+		}
+
+		// An actor collected without EndPlay left its entry behind, the new actor at that address replaces it
+		WeakObject<AActor>& existing = actors[iter->second];
+		if (!existing.Get())
+			existing = WeakObject<AActor>(actor);
+	}
+
+	void ActorRegistry::ActorSet::Remove(AActor* actor)
+	{
+		const auto iter = positions.find(actor);
+		if (iter != positions.end())
+			RemoveAt(iter->second);
+	}
+
+	void ActorRegistry::ActorSet::RemoveAt(size_t position)
+	{
+		positions.erase(actors[position].GetRaw());
+
+		if (position != actors.size() - 1)
+		{
+			actors[position] = actors.back();
+			positions[actors[position].GetRaw()] = position;
+		}
+
+		actors.pop_back();
+	}
+
+	// ActorRegistry
+
+	ActorRegistry& ActorRegistry::Get()
+	{
+		static ActorRegistry instance;
+		return instance;
+	}
+
+	void ActorRegistry::Track(UClass* the_class, HMODULE owner)
+	{
+		if (!the_class)
+			return;
+
+		auto [iter, inserted] = tracked_.try_emplace(the_class);
+		++iter->second.owners[owner];
+
+		if (!inserted)
+			return;
+
+		// Classes resolved before do not know about the new set
+		class_sets_.clear();
+
+		UWorld* world = GetApiUtils().GetWorld();
+		if (world)
+		{
+			TArray<AActor*> actors;
+			UGameplayStatics::GetAllActorsOfClass(world, the_class, &actors);
+
+			for (AActor* actor : actors)
+				iter->second.Add(actor);
+		}
+
+		SetHooksEnabled(true);
+	}
+
+	void ActorRegistry::Untrack(UClass* the_class, HMODULE owner)
+	{
+		const auto iter = tracked_.find(the_class);
+		if (iter == tracked_.end())
+			return;
+
+		const auto owner_iter = iter->second.owners.find(owner);
+		if (owner_iter == iter->second.owners.end())
+			return;
+
+		if (--owner_iter->second == 0)
+			iter->second.owners.erase(owner_iter);
+
+		if (iter->second.owners.empty())
+			Drop(the_class);
+	}
+
+	void ActorRegistry::UntrackModule(HMODULE owner)
+	{
+		std::vector<UClass*> unused;
+		for (auto& [the_class, set] : tracked_)
+		{
+			if (set.owners.erase(owner) && set.owners.empty())
+				unused.push_back(the_class);
+		}
+
+		for (UClass* the_class : unused)
+			Drop(the_class);
+	}
+
+	void ActorRegistry::Drop(UClass* the_class)
+	{
+		tracked_.erase(the_class);
+		class_sets_.clear();
+
+		if (tracked_.empty())
+			SetHooksEnabled(false);
+	}
+
+	void ActorRegistry::SetHooksEnabled(bool enabled)
+	{
+		if (hooked_ == enabled)
+			return;
+
+		auto& hooks = API::game_api->GetHooks();
+		if (enabled)
+		{
+			hooks->SetHook("AActor.DispatchBeginPlay(bool)", &Hook_AActor_DispatchBeginPlay, &AActor_DispatchBeginPlay_original);
+			hooks->SetHook("AActor.RouteEndPlay(EEndPlayReason::Type)", &Hook_AActor_RouteEndPlay, &AActor_RouteEndPlay_original);
+		}
+		else
+		{
+			hooks->DisableHook("AActor.DispatchBeginPlay(bool)", &Hook_AActor_DispatchBeginPlay);
+			hooks->DisableHook("AActor.RouteEndPlay(EEndPlayReason::Type)", &Hook_AActor_RouteEndPlay);
+		}
+
+		hooked_ = enabled;
+	}
+
+	const std::vector<ActorRegistry::ActorSet*>& ActorRegistry::FindSets(UClass* the_class)
+	{
+		auto iter = class_sets_.find(the_class);
+		if (iter != class_sets_.end() && iter->second.weak_class.Get() == the_class)
+			return iter->second.sets;
+
+		ClassSets class_sets{WeakClass(the_class), {}};
+		for (UStruct* ancestor = the_class; ancestor != nullptr; ancestor = ancestor->SuperStructField())
+		{
+			const auto tracked = tracked_.find(static_cast<UClass*>(ancestor));
+			if (tracked != tracked_.end())
+				class_sets.sets.push_back(&tracked->second);
+		}
+
+		return class_sets_.insert_or_assign(the_class, std::move(class_sets)).first->second.sets;
+	}
+
+	void ActorRegistry::OnBeginPlay(AActor* actor)
+	{
+		if (!actor || tracked_.empty())
+			return;
+
+		for (ActorSet* set : FindSets(actor->ClassPrivateField()))
+			set->Add(actor);
+	}
+
+	void ActorRegistry::OnEndPlay(AActor* actor)
+	{
+		if (!actor || tracked_.empty())
+			return;
+
+		for (ActorSet* set : FindSets(actor->ClassPrivateField()))
+			set->Remove(actor);
+	}
+
+	bool ActorRegistry::GetActors(UClass* the_class, TArray<AActor*>& actors)
+	{
+		actors.Reset();
+
+		const auto iter = tracked_.find(the_class);
+		if (iter == tracked_.end())
+			return false;
+
+		ActorSet& set = iter->second;
+		actors.Reserve(static_cast<int>(set.actors.size()));
+
+		for (size_t position = 0; position < set.actors.size();)
+		{
+			// Actors collected without an EndPlay are dropped here
+			AActor* actor = set.actors[position].Get();
+			if (!actor)
+			{
+				set.RemoveAt(position);
+				continue;
+			}
+
+			actors.Add(actor);
+			++position;
+		}
+
+		return true;
+	}
+} // namespace AsaApi
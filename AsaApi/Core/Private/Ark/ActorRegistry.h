@@ -0,0 +1,83 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Live actors of the classes plugins asked for, kept up to date by the DispatchBeginPlay and RouteEndPlay hooks.
+	 *
+	 * Nothing is hooked until the first class is tracked. A tracked class collects its own actors and the actors of
+	 * all its subclasses, so reading it costs only the number of actors in it. Game thread only.
+	 */
+	class ActorRegistry
+	{
+	public:
+		static ActorRegistry& Get();
+
+		ActorRegistry(const ActorRegistry&) = delete;
+		ActorRegistry(ActorRegistry&&) = delete;
+		ActorRegistry& operator=(const ActorRegistry&) = delete;
+		ActorRegistry& operator=(ActorRegistry&&) = delete;
+
+		/**
+		 * \brief Starts collecting actors of `the_class` for `owner`, the actors that already exist are added right away
+		 */
+		void Track(UClass* the_class, HMODULE owner);
+
+		/**
+		 * \brief Stops collecting for `owner`, the class is dropped once no plugin tracks it anymore
+		 */
+		void Untrack(UClass* the_class, HMODULE owner);
+
+		/**
+		 * \brief Drops everything the plugin tracked. Called by the plugin manager before `FreeLibrary`.
+		 */
+		void UntrackModule(HMODULE owner);
+
+		/**
+		 * \brief Replaces the contents of `actors` with the live actors of a tracked class
+		 * \return False if the class is not tracked
+		 */
+		bool GetActors(UClass* the_class, TArray<AActor*>& actors);
+
+		void OnBeginPlay(AActor* actor);
+		void OnEndPlay(AActor* actor);
+
+	private:
+		struct ActorSet
+		{
+			std::vector<WeakObject<AActor>> actors;
+			std::unordered_map<AActor*, size_t> positions;
+			std::unordered_map<HMODULE, int> owners;
+
+			void Add(AActor* actor);
+			void Remove(AActor* actor);
+			void RemoveAt(size_t position);
+		};
+
+		// Tracked sets an actor of a class belongs to, resolved once per class from its superclass chain
+		struct ClassSets
+		{
+			WeakClass weak_class;
+			std::vector<ActorSet*> sets;
+		};
+
+		ActorRegistry() = default;
+		~ActorRegistry() = default;
+
+		const std::vector<ActorSet*>& FindSets(UClass* the_class);
+		void Drop(UClass* the_class);
+		void SetHooksEnabled(bool enabled);
+
+		// Node based, the ActorSet pointers in class_sets_ stay valid until the class is dropped
+		std::unordered_map<UClass*, ActorSet> tracked_;
+		std::unordered_map<UClass*, ClassSets> class_sets_;
+		bool hooked_{false};
+	};
+} // namespace AsaApi
@@ -1,10 +1,14 @@
 #include "ApiUtils.h"
 
 #include "../IBaseApi.h"
+#include "../PluginManager/PluginProfiler.h"
+#include "ActorRegistry.h"
+#include "ObjectScanner.h"
 #include "Ark/MessagingManager.h"
 #include "Ark/AsaApiUtilsMessagingManager.h"
-#include <fstream>
-#include "json.hpp"
+#include <ConfigService.h>
+
+#include <intrin.h>
 
 namespace AsaApi
 {
@@ -54,66 +58,174 @@ namespace AsaApi
 		cheatmanager_ = cheatmanager;
 	}
 
-	void ApiUtils::SetPlayerController(AShooterPlayerController* player_controller)
-	{		
-		if (!player_controller)
-			return;
-		
-		const FString eos_id = AsaApi::IApiUtils::GetEOSIDFromController(player_controller);
+	// Players
 
-		if (!eos_id.IsEmpty())
-		{
-			eos_id_map_[eos_id] = player_controller;
-		}
+	void ApiUtils::SetPlayerController(AShooterPlayerController* player_controller)
+	{
+		players_.Add(player_controller);
 	}
 
 	void ApiUtils::RemovePlayerController(AShooterPlayerController* player_controller)
 	{
-		if (!player_controller)
-			return;
-
-		const FString eos_id = AsaApi::IApiUtils::GetEOSIDFromController(player_controller);
+		players_.Remove(player_controller);
+	}
 
-		if (!eos_id.IsEmpty())
-		{
-			eos_id_map_.erase(eos_id);
-		}
+	void ApiUtils::RefreshPlayerControllers()
+	{
+		players_.Refresh();
 	}
 
 	AShooterPlayerController* ApiUtils::FindPlayerFromEOSID_Internal(const FString& eos_id) const
 	{
-		AShooterPlayerController* found_player = nullptr;
 		if (eos_id.IsEmpty())
 		{
-			return found_player;
+			return nullptr;
 		}
-		auto iter = eos_id_map_.find(eos_id);
-		if (iter != eos_id_map_.end()
-			&& iter->first == eos_id)
+
+		RegisterMissedPlayers();
+		return players_.FindByEOSID(eos_id);
+	}
+
+	AShooterPlayerController* ApiUtils::FindPlayerFromPlayerID_Internal(uint64 player_id) const
+	{
+		if (player_id == 0)
 		{
-			found_player = iter->second;
+			return nullptr;
 		}
 
-		if (found_player == nullptr)
+		RegisterMissedPlayers();
+		return players_.FindByPlayerID(player_id);
+	}
+
+	AShooterPlayerController* ApiUtils::FindPlayerFromPlatformName_Internal(const FString& platform_name) const
+	{
+		RegisterMissedPlayers();
+		return players_.FindByPlatformName(platform_name);
+	}
+
+	TArray<AShooterPlayerController*> ApiUtils::FindPlayersFromCharacterName_Internal(const FString& character_name,
+		ESearchCase::Type search, bool full_match) const
+	{
+		RegisterMissedPlayers();
+		return players_.FindByCharacterName(character_name, search, full_match);
+	}
+
+	TArray<AShooterPlayerController*> ApiUtils::FindPlayersFromTribeID_Internal(int tribe_id) const
+	{
+		RegisterMissedPlayers();
+		return players_.FindByTribeID(tribe_id);
+	}
+
+	void ApiUtils::RegisterMissedPlayers() const
+	{
+		UWorld* world = GetWorld();
+		if (!world)
+			return;
+
+		// Controllers the hooks missed, e.g. players that joined before the API was loaded. The counts only differ
+		// until the next Refresh drops the controllers destroyed without a logout, so the list is rarely walked.
+		const auto& player_controllers = world->PlayerControllerListField();
+		if (player_controllers.Num() == players_.Num())
+			return;
+
+		for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
 		{
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
+			AShooterPlayerController* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
 
-				if (shooter_pc)
-				{
-					const FString& iter_eos_id = *API::game_api->GetApiUtils()->GetEOSIDFromController(shooter_pc);
-					if (iter_eos_id == eos_id)
-					{
-						found_player = shooter_pc;
-						break;
-					}
-				}
-			}
+			if (shooter_pc && !players_.Contains(shooter_pc))
+				players_.Add(shooter_pc);
 		}
+	}
 
-		return found_player;
+	// Blueprints
+
+	FString ApiUtils::GetClassBlueprint_Internal(UClass* the_class)
+	{
+		return blueprints_.GetClassBlueprint(the_class);
+	}
+
+	FString ApiUtils::GetObjectBlueprint_Internal(UClass* the_class)
+	{
+		return blueprints_.GetObjectBlueprint(the_class);
+	}
+
+	FName ApiUtils::GetClassBlueprintName_Internal(UClass* the_class)
+	{
+		return blueprints_.GetClassBlueprintName(the_class);
+	}
+
+	bool ApiUtils::IsBlueprint_Internal(UClass* the_class, const FString& blueprint)
+	{
+		return blueprints_.IsBlueprint(the_class, blueprint);
+	}
+
+	// Classes
+
+	UClass* ApiUtils::LoadClass_Internal(const FString& blueprint)
+	{
+		return classes_.LoadClass(blueprint);
+	}
+
+	int ApiUtils::PreloadClasses_Internal(const TArray<FString>& blueprints)
+	{
+		return classes_.Preload(blueprints);
+	}
+
+	ClassCache::Stats ApiUtils::GetClassCacheStats()
+	{
+		return classes_.GetStats();
+	}
+
+	bool ApiUtils::IsChildOf_Internal(UClass* the_class, UClass* base)
+	{
+		return hierarchy_.IsChildOf(the_class, base);
+	}
+
+	bool ApiUtils::IsClassCached_Internal(UClass* the_class)
+	{
+		return hierarchy_.IsKnown(the_class);
+	}
+
+	void ApiUtils::CacheClass_Internal(UClass* the_class)
+	{
+		hierarchy_.Add(the_class);
+	}
+
+	// Actors
+
+	void ApiUtils::TrackActors_Internal(UClass* the_class)
+	{
+		ActorRegistry::Get().Track(the_class, API::PluginProfiler::ModuleFromAddress(_ReturnAddress()));
+	}
+
+	void ApiUtils::UntrackActors_Internal(UClass* the_class)
+	{
+		ActorRegistry::Get().Untrack(the_class, API::PluginProfiler::ModuleFromAddress(_ReturnAddress()));
+	}
+
+	bool ApiUtils::GetTrackedActors_Internal(UClass* the_class, TArray<AActor*>& actors)
+	{
+		return ActorRegistry::Get().GetActors(the_class, actors);
+	}
+
+	// Spatial queries
+
+	void ApiUtils::GetAllActorsInRange_Internal(ActorsInRangeQuery* queries, int count)
+	{
+		spatial_queries_.Run(GetWorld(), queries, count);
+	}
+
+	void ApiUtils::NewSpatialQueryTick()
+	{
+		spatial_queries_.NewTick();
+	}
+
+	// Objects
+
+	void ApiUtils::GetObjectsOfClass_Internal(UClass* the_class, TArray<UObject*>& objects, bool include_subclasses)
+	{
+		ObjectScanner::Scan(Globals::GUObjectArray()().ObjObjects, ObjectScanner::GetGameLayout(), the_class,
+			include_subclasses, objects);
 	}
 
 	UShooterCheatManager* ApiUtils::GetCheatManager() const
@@ -186,16 +298,9 @@ namespace AsaApi
 
 	std::shared_ptr<MessagingManager> ApiUtils::ReadApiMessagingManager()
 	{
-		const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{ config_path };
-		if (!file.is_open())
-			return std::make_shared<MessagingManager>();
-
-		nlohmann::json config;
-		file >> config;
-		file.close();
+		const auto config = API::ConfigService::Get().GetConfig();
 
-		std::string messaging_manager_name = config["settings"].value("DefaultMessaging", "Default");
+		std::string messaging_manager_name = API::ConfigService::GetSettings(config).value("DefaultMessaging", "Default");
 		if (messaging_manager_name == "Default")
 			return std::make_shared<MessagingManager>();
 		else if (messaging_manager_name == "AsaApiUtilsMod")
@@ -2,6 +2,12 @@
 
 #include <IApiUtils.h>
 
+#include "BlueprintCache.h"
+#include "ClassCache.h"
+#include "ClassHierarchy.h"
+#include "PlayerRegistry.h"
+#include "SpatialQueries.h"
+
 namespace AsaApi
 {
 	class ApiUtils : public IApiUtils
@@ -29,21 +35,50 @@ namespace AsaApi
 		AShooterPlayerController* FindPlayerFromEOSID_Internal(const FString& eos_id) const override;
 		void SetPlayerController(AShooterPlayerController* player_controller);
 		void RemovePlayerController(AShooterPlayerController* player_controller);
+		void RefreshPlayerControllers();
 
 		std::shared_ptr<MessagingManager> GetMessagingManagerInternal(const FString& forPlugin) const override;
 		void SetMessagingManagerInternal(const FString& forPlugin, std::shared_ptr<MessagingManager> manager) override;
+		AShooterPlayerController* FindPlayerFromPlayerID_Internal(uint64 player_id) const override;
+		AShooterPlayerController* FindPlayerFromPlatformName_Internal(const FString& platform_name) const override;
+		TArray<AShooterPlayerController*> FindPlayersFromCharacterName_Internal(const FString& character_name,
+			ESearchCase::Type search, bool full_match) const override;
+		TArray<AShooterPlayerController*> FindPlayersFromTribeID_Internal(int tribe_id) const override;
+		FString GetClassBlueprint_Internal(UClass* the_class) override;
+		FString GetObjectBlueprint_Internal(UClass* the_class) override;
+		FName GetClassBlueprintName_Internal(UClass* the_class) override;
+		bool IsBlueprint_Internal(UClass* the_class, const FString& blueprint) override;
+		UClass* LoadClass_Internal(const FString& blueprint) override;
+		int PreloadClasses_Internal(const TArray<FString>& blueprints) override;
+		ClassCache::Stats GetClassCacheStats();
+		void TrackActors_Internal(UClass* the_class) override;
+		void UntrackActors_Internal(UClass* the_class) override;
+		bool GetTrackedActors_Internal(UClass* the_class, TArray<AActor*>& actors) override;
+		void GetObjectsOfClass_Internal(UClass* the_class, TArray<UObject*>& objects, bool include_subclasses) override;
+		bool IsChildOf_Internal(UClass* the_class, UClass* base) override;
+		bool IsClassCached_Internal(UClass* the_class) override;
+		void CacheClass_Internal(UClass* the_class) override;
+		void GetAllActorsInRange_Internal(ActorsInRangeQuery* queries, int count) override;
+		void NewSpatialQueryTick();
 		void RemoveMessagingManagerInternal(const FString& forPlugin);
 		void CheckMessagingManagersRequirements();
 
 	private:
 		std::shared_ptr<MessagingManager> ReadApiMessagingManager();
 
+		// Adds the world's player controllers the registry does not know yet, before each lookup
+		void RegisterMissedPlayers() const;
+
 	private:
 		UWorld* u_world_{ nullptr };
 		AShooterGameMode* shooter_game_mode_{ nullptr };
 		ServerStatus status_{ 0 };
 		UShooterCheatManager* cheatmanager_{ nullptr };
-		std::unordered_map<const FString, AShooterPlayerController*, FStringHash, FStringEqual> eos_id_map_;
+		mutable PlayerRegistry players_; // Locks itself, the const lookups register controllers the hooks missed
+		BlueprintCache blueprints_;
+		ClassCache classes_;
+		ClassHierarchy hierarchy_;
+		SpatialQueries spatial_queries_;
 		std::unordered_map<const FString, std::shared_ptr<MessagingManager>, FStringHash, FStringEqual> messaging_managers_;
 	};
 } // namespace AsaApi
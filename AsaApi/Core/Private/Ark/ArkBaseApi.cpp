@@ -1,6 +1,7 @@
 #include "ArkBaseApi.h"
 #include "..\Private\PDBReader\PDBReader.h"
 #include "..\PluginManager\PluginManager.h"
+#include "..\PluginManager\PluginProfiler.h"
 #include "..\Private\Offsets.h"
 #include "..\Private\Cache.h"
 #include "..\Hooks.h"
@@ -10,14 +11,51 @@
 #include "HooksImpl.h"
 #include "ApiUtils.h"
 #include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
 #include "Requests.h"
+#include "ConfigService.h"
 #include <minizip/unzip.h>
+#ifdef ASAAPI_DEV_COMMANDS
+#include <atomic>
+#include <thread>
+#include "../Tools/StringKernelsBenchmark.h"
+#include "../Tools/ObjectScannerBenchmark.h"
+#include "../Tools/WebSocketsSelfTest.h"
+#endif
 #include <Windows.h>
 
 namespace API
 {
 	constexpr float api_version = 1.21f;
 
+	namespace
+	{
+		/**
+		 * \brief Fetches the SHA-256 the CDN publishes next to a cache archive, as `<archive>.sha256` in sha256sum format
+		 * \return Lowercase hex digest, empty if there is none
+		 */
+		std::string DownloadCacheHash(const std::string& url, const std::filesystem::path& localFile)
+		{
+			std::string hash;
+			if (API::Requests::DownloadFile(url, localFile.string(), {}, "", 1))
+			{
+				std::ifstream file(localFile);
+				file >> hash;
+			}
+
+			std::error_code error;
+			std::filesystem::remove(localFile, error);
+
+			if (hash.size() != 64 || !std::all_of(hash.begin(), hash.end(), [](unsigned char c) { return std::isxdigit(c); }))
+				return "";
+
+			std::transform(hash.begin(), hash.end(), hash.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return hash;
+		}
+	} // namespace
+
 	ArkBaseApi::ArkBaseApi()
 		: commands_(std::make_unique<AsaApi::Commands>()),
 		hooks_(std::make_unique<Hooks>()),
@@ -27,8 +65,8 @@ namespace API
 
 	bool ArkBaseApi::Init()
 	{
-		nlohmann::json apiConfig = ArkBaseApi::GetConfig();
-		const nlohmann::json autoCacheConfig = apiConfig.value("settings", nlohmann::json::object()).value("AutomaticCacheDownload", nlohmann::json::object());
+		const auto apiConfig = ConfigService::Get().GetConfig();
+		const nlohmann::json autoCacheConfig = ConfigService::GetSettings(apiConfig).value("AutomaticCacheDownload", nlohmann::json::object());
 		namespace fs = std::filesystem;
 		
 		Log::GetLog()->info("-----------------------------------------------");
@@ -146,6 +184,7 @@ namespace API
 
 		Offsets::Get().Init(move(offsets_dump), move(bitfields_dump));
 		Sleep(10);
+		ConfigService::Get().Start();
 		AsaApi::InitHooks();
 		Log::GetLog()->info("API was successfully loaded");
 		Log::GetLog()->info("-----------------------------------------------\n");
@@ -153,23 +192,14 @@ namespace API
 		return true;
 	}
 
-	nlohmann::json ArkBaseApi::GetConfig()
-	{
-		const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{ config_path };
-		if (!file.is_open())
-			return false;
-
-		nlohmann::json config;
-		file >> config;
-		file.close();
-
-		return config;
-	}
-
 	bool ArkBaseApi::DownloadCacheFiles(const std::filesystem::path downloadFile, const std::filesystem::path localFile)
 	{
-		if (API::Requests::DownloadFile(downloadFile.string(), localFile.string()))
+		const std::string expectedHash = DownloadCacheHash(downloadFile.string() + ".sha256",
+			std::filesystem::path(localFile).concat(".sha256"));
+		if (expectedHash.empty())
+			Log::GetLog()->warn("No SHA-256 published for the cache archive, only the archive checksums are verified");
+
+		if (API::Requests::DownloadFile(downloadFile.string(), localFile.string(), {}, expectedHash))
 		{
 			std::string outputFolder = localFile.parent_path().string();
 			unzFile zf = unzOpen(localFile.string().c_str());
@@ -230,7 +260,14 @@ namespace API
 							out.write(readBuffer, bytesRead);
 					} while (bytesRead > 0);
 
-					unzCloseCurrentFile(zf);
+					// Fails with UNZ_CRCERROR if the entry does not match its checksum, e.g. after a corrupted download
+					if (unzCloseCurrentFile(zf) != UNZ_OK)
+					{
+						Log::GetLog()->error("Cache archive entry '{}' is corrupted", filename);
+						unzClose(zf);
+						return false;
+					}
+
 					out.close();
 				}
 
@@ -284,7 +321,25 @@ namespace API
 		GetCommands()->AddConsoleCommand("plugins.unload", &UnloadPluginCmd);
 		GetCommands()->AddRconCommand("plugins.load", &LoadPluginRcon);
 		GetCommands()->AddRconCommand("plugins.unload", &UnloadPluginRcon);
+		GetCommands()->AddConsoleCommand("plugins.stats", &PluginsStatsCmd);
+		GetCommands()->AddRconCommand("plugins.stats", &PluginsStatsRcon);
+		GetCommands()->AddConsoleCommand("requests.stats", &RequestsStatsCmd);
+		GetCommands()->AddRconCommand("requests.stats", &RequestsStatsRcon);
+		GetCommands()->AddConsoleCommand("classes.stats", &ClassesStatsCmd);
+		GetCommands()->AddRconCommand("classes.stats", &ClassesStatsRcon);
+		GetCommands()->AddConsoleCommand("log.level", &LogLevelCmd);
+		GetCommands()->AddRconCommand("log.level", &LogLevelRcon);
 		GetCommands()->AddRconCommand("map.setserverid", &SetServerID);
+#ifdef ASAAPI_DEV_COMMANDS
+		GetCommands()->AddConsoleCommand("strings.benchmark", &StringsBenchmarkCmd);
+		GetCommands()->AddRconCommand("strings.benchmark", &StringsBenchmarkRcon);
+		GetCommands()->AddConsoleCommand("objects.benchmark", &ObjectsBenchmarkCmd);
+		GetCommands()->AddRconCommand("objects.benchmark", &ObjectsBenchmarkRcon);
+		GetCommands()->AddConsoleCommand("websockets.selftest", &WebSocketsSelfTestCmd);
+		GetCommands()->AddRconCommand("websockets.selftest", &WebSocketsSelfTestRcon);
+#endif
+
+		GetCommands()->AddOnTimerCallback("API.ReportSuppressedLogLines", &ReportSuppressedLogLines);
 	}
 
 	FString ArkBaseApi::LoadPlugin(FString* cmd)
@@ -341,6 +396,78 @@ namespace API
 		return L"Plugin not found";
 	}
 
+	FString ArkBaseApi::PluginsStats(FString* /*cmd*/)
+	{
+		std::string reply;
+		for (const std::string& line : PluginProfiler::Get().Describe())
+		{
+			Log::GetLog()->info(line);
+			reply += line + "\n";
+		}
+
+		return FString(reply);
+	}
+
+	FString ArkBaseApi::RequestsStats(FString* /*cmd*/)
+	{
+		const std::vector<std::string> lines = Requests::Get().GetHostStatistics();
+		if (lines.empty())
+			return L"No HTTP requests were made yet";
+
+		std::string reply;
+		for (const std::string& line : lines)
+		{
+			Log::GetLog()->info(line);
+			reply += line + "\n";
+		}
+
+		return FString(reply);
+	}
+
+	FString ArkBaseApi::ClassesStats(FString* /*cmd*/)
+	{
+		const auto stats = dynamic_cast<AsaApi::ApiUtils&>(*API::game_api->GetApiUtils()).GetClassCacheStats();
+		const uint64_t lookups = stats.hits + stats.misses;
+
+		const std::string reply = fmt::format(
+			"Class cache: {} classes, {} hits, {} misses ({:.1f}% hit rate), {} failed loads, {} reloaded after GC",
+			stats.entries, stats.hits, stats.misses, lookups > 0 ? 100.0 * stats.hits / lookups : 0.0,
+			stats.failed_loads, stats.reloads);
+		Log::GetLog()->info(reply);
+
+		return FString(reply);
+	}
+
+	FString ArkBaseApi::LogLevel(FString* cmd)
+	{
+		TArray<FString> parsed;
+		cmd->ParseIntoArray(parsed, L" ", true);
+
+		if (!parsed.IsValidIndex(2))
+		{
+			std::string reply = "Usage: log.level <logger|*> <trace|debug|info|warning|error|critical|off>\n";
+			for (const auto& [name, level] : GetLoggerLevels())
+			{
+				reply += fmt::format("{}: {}\n", name, spdlog::level::to_str(level));
+			}
+
+			return FString(reply);
+		}
+
+		const std::string name = parsed[1].ToString();
+
+		spdlog::level::level_enum level;
+		if (!Log::ParseLevel(parsed[2].ToString(), level))
+			return L"Unknown log level";
+
+		if (!SetLoggerLevel(name, level))
+			return *FString::Format("No logger named {} is loaded, the level applies once it registers", name);
+
+		Log::GetLog()->info("Log level of {} set to {}", name, spdlog::level::to_str(level));
+
+		return *FString::Format("Log level of {} set to {}", name, spdlog::level::to_str(level));
+	}
+
 	// Command Callbacks
 	void ArkBaseApi::LoadPluginCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
 	{
@@ -354,6 +481,30 @@ namespace API
 		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *UnloadPlugin(cmd));
 	}
 
+	void ArkBaseApi::PluginsStatsCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *PluginsStats(cmd));
+	}
+
+	void ArkBaseApi::RequestsStatsCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *RequestsStats(cmd));
+	}
+
+	void ArkBaseApi::ClassesStatsCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *ClassesStats(cmd));
+	}
+
+	void ArkBaseApi::LogLevelCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *LogLevel(cmd));
+	}
+
 	// RCON Command Callbacks
 	void ArkBaseApi::LoadPluginRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet, UWorld* /*unused*/)
 	{
@@ -368,6 +519,34 @@ namespace API
 		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
 	}
 
+	void ArkBaseApi::PluginsStatsRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = PluginsStats(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void ArkBaseApi::RequestsStatsRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = RequestsStats(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void ArkBaseApi::ClassesStatsRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = ClassesStats(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void ArkBaseApi::LogLevelRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = LogLevel(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
 	void ArkBaseApi::SetServerID(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
 		UWorld* /*unused*/)
 	{
@@ -381,11 +560,11 @@ namespace API
 
 			try
 			{
+				const FString world_data_blueprint(L"Blueprint'/Script/ShooterGame.PrimalPersistentWorldData'");
 				const auto& actors = AsaApi::GetApiUtils().GetWorld()->PersistentLevelField().Get()->ActorsField();
 				for (auto actor : actors)
 				{
-					FString bp = AsaApi::GetApiUtils().GetBlueprint(actor);
-					if (bp.Equals("Blueprint'/Script/ShooterGame.PrimalPersistentWorldData'"))
+					if (AsaApi::IApiUtils::IsBlueprint(actor, world_data_blueprint))
 					{
 						actor->TargetingTeamField() = new_server_id;
 
@@ -411,4 +590,150 @@ namespace API
 		
 		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
 	}
+
+#ifdef ASAAPI_DEV_COMMANDS
+	// Benchmarks and self-tests, only built when ASAAPI_DEV_COMMANDS is defined. The CPU bound ones run on their own
+	// thread, the WebSockets one drives a loopback server through the regular ticks. The Requests benchmark is the
+	// RequestsBenchmark plugin in Benchmarks/.
+
+	namespace
+	{
+		std::atomic<bool> dev_benchmark_running{false};
+
+		/**
+		 * \brief Runs a CPU bound benchmark on its own thread and writes the report to the log
+		 * \return False if another benchmark is still running
+		 */
+		template <typename Benchmark>
+		bool StartDevBenchmark(Benchmark benchmark)
+		{
+			if (dev_benchmark_running.exchange(true))
+				return false;
+
+			std::thread([benchmark = std::move(benchmark)]
+			{
+				try
+				{
+					for (const std::string& line : benchmark())
+					{
+						Log::GetLog()->info(line);
+					}
+				}
+				catch (const std::exception& error)
+				{
+					Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+				}
+
+				dev_benchmark_running = false;
+			}).detach();
+
+			return true;
+		}
+	} // namespace
+
+	FString ArkBaseApi::StringsBenchmark(FString* cmd)
+	{
+		TArray<FString> parsed;
+		cmd->ParseIntoArray(parsed, L" ", true);
+
+		int rounds = 10000;
+		if (parsed.IsValidIndex(1))
+		{
+			try
+			{
+				rounds = std::stoi(parsed[1].ToString());
+			}
+			catch (const std::exception&)
+			{
+				rounds = 0;
+			}
+		}
+
+		if (rounds < 1 || rounds > 100000)
+			return L"Usage: strings.benchmark [rounds 1-100000]";
+
+		if (!StartDevBenchmark([rounds] { return API::RunStringKernelsBenchmark(rounds); }))
+			return L"A benchmark is running";
+
+		return L"Strings benchmark started, the results go to the log";
+	}
+
+	FString ArkBaseApi::ObjectsBenchmark(FString* cmd)
+	{
+		TArray<FString> parsed;
+		cmd->ParseIntoArray(parsed, L" ", true);
+
+		int object_count = 1000000;
+		if (parsed.IsValidIndex(1))
+		{
+			try
+			{
+				object_count = std::stoi(parsed[1].ToString());
+			}
+			catch (const std::exception&)
+			{
+				object_count = 0;
+			}
+		}
+
+		if (object_count < 1 || object_count > 2000000)
+			return L"Usage: objects.benchmark [objects 1-2000000]";
+
+		if (!StartDevBenchmark([object_count] { return API::RunObjectScannerBenchmark(object_count); }))
+			return L"A benchmark is running";
+
+		return L"Objects benchmark started, the results go to the log";
+	}
+
+	FString ArkBaseApi::WebSocketsSelfTest(FString* /*cmd*/)
+	{
+		auto& self_test = API::WebSocketsSelfTest::Get();
+		if (self_test.IsRunning())
+			return L"WebSocket self-test is running";
+
+		const std::string reply = self_test.Start();
+		Log::GetLog()->info(reply);
+
+		return FString(reply);
+	}
+
+	void ArkBaseApi::StringsBenchmarkCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *StringsBenchmark(cmd));
+	}
+
+	void ArkBaseApi::ObjectsBenchmarkCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *ObjectsBenchmark(cmd));
+	}
+
+	void ArkBaseApi::WebSocketsSelfTestCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *WebSocketsSelfTest(cmd));
+	}
+
+	void ArkBaseApi::StringsBenchmarkRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = StringsBenchmark(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void ArkBaseApi::ObjectsBenchmarkRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = ObjectsBenchmark(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void ArkBaseApi::WebSocketsSelfTestRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet,
+		UWorld* /*unused*/)
+	{
+		FString reply = WebSocketsSelfTest(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+#endif
 } // namespace API
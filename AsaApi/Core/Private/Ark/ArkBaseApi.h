@@ -23,21 +23,53 @@ namespace API
 		std::unique_ptr<AsaApi::IHooks>& GetHooks() override;
 		std::unique_ptr<AsaApi::IApiUtils>& GetApiUtils() override;
 
-		nlohmann::json GetConfig();
 	private:
 		bool DownloadCacheFiles(const std::filesystem::path downloadFile, const std::filesystem::path localFile);
 
 		// Callbacks
 		static FString LoadPlugin(FString* cmd);
 		static FString UnloadPlugin(FString* cmd);
+		static FString PluginsStats(FString* cmd);
+		static FString RequestsStats(FString* cmd);
+		static FString ClassesStats(FString* cmd);
+		static FString LogLevel(FString* cmd);
 
 		static void LoadPluginCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
 		static void UnloadPluginCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void PluginsStatsCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void RequestsStatsCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void ClassesStatsCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void LogLevelCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
 
 		static void LoadPluginRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
 			UWorld* /*unused*/);
 		static void UnloadPluginRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
 			UWorld* /*unused*/);
+		static void PluginsStatsRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+		static void RequestsStatsRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+		static void ClassesStatsRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+		static void LogLevelRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+
+#ifdef ASAAPI_DEV_COMMANDS
+		static FString StringsBenchmark(FString* cmd);
+		static FString ObjectsBenchmark(FString* cmd);
+		static FString WebSocketsSelfTest(FString* cmd);
+
+		static void StringsBenchmarkCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void ObjectsBenchmarkCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+		static void WebSocketsSelfTestCmd(APlayerController* /*player_controller*/, FString* /*cmd*/, bool /*unused*/);
+
+		static void StringsBenchmarkRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+		static void ObjectsBenchmarkRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+		static void WebSocketsSelfTestRcon(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
+			UWorld* /*unused*/);
+#endif
 
 		static void SetServerID(RCONClientConnection* /*rcon_connection*/, RCONPacket* /*rcon_packet*/,
 			UWorld* /*unused*/);
@@ -0,0 +1,84 @@
+#include "BlueprintCache.h"
+
+#include <mutex>
+
+namespace AsaApi
+{
+	FString BlueprintCache::ResolveClassBlueprint(UClass* the_class)
+	{
+		FString path;
+		TSubclassOf<UObject> subclass;
+		subclass.uClass = the_class;
+		FString* result = UVictoryCore::ClassToStringReference(&path, &subclass);
+
+		if (!result || result->IsEmpty())
+			return FString("");
+
+		if (result->EndsWith(TEXT("_C")))
+			return FString::Printf(TEXT("Blueprint'%s'"), *result->LeftChop(2));
+		else
+			return FString::Printf(TEXT("Blueprint'%s'"), **result);
+	}
+
+	BlueprintCache::Entry BlueprintCache::Find(UClass* the_class)
+	{
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+
+			const auto iter = by_class_.find(the_class);
+			if (iter != by_class_.end() && iter->second.weak_class.Get() == the_class)
+				return iter->second;
+		}
+
+		// Resolved without holding the lock, two threads may both resolve a new class but store the same result
+		Entry entry;
+		entry.weak_class = WeakClass(the_class);
+		entry.class_blueprint = ResolveClassBlueprint(the_class);
+		entry.object_blueprint = entry.class_blueprint.Replace(L"Default__", L"", ESearchCase::CaseSensitive);
+		if (!entry.class_blueprint.IsEmpty())
+			entry.name = FName(entry.class_blueprint.ToString().c_str(), FNAME_Add);
+
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+
+		by_class_[the_class] = entry;
+		if (!entry.object_blueprint.IsEmpty())
+			by_blueprint_[entry.object_blueprint] = entry.weak_class;
+
+		return entry;
+	}
+
+	FString BlueprintCache::GetClassBlueprint(UClass* the_class)
+	{
+		return the_class ? Find(the_class).class_blueprint : FString("");
+	}
+
+	FString BlueprintCache::GetObjectBlueprint(UClass* the_class)
+	{
+		return the_class ? Find(the_class).object_blueprint : FString("");
+	}
+
+	FName BlueprintCache::GetClassBlueprintName(UClass* the_class)
+	{
+		return the_class ? Find(the_class).name : FName();
+	}
+
+	bool BlueprintCache::IsBlueprint(UClass* the_class, const FString& blueprint)
+	{
+		if (!the_class || blueprint.IsEmpty())
+			return false;
+
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+
+			const auto iter = by_blueprint_.find(blueprint);
+			if (iter != by_blueprint_.end())
+			{
+				if (UClass* known_class = iter->second.Get())
+					return known_class == the_class;
+			}
+		}
+
+		// Unknown or collected, resolving the class registers its blueprint if it is the one asked for
+		return Find(the_class).object_blueprint.Equals(blueprint, ESearchCase::CaseSensitive);
+	}
+} // namespace AsaApi
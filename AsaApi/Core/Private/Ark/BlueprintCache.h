@@ -0,0 +1,59 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Blueprint paths of classes, resolved once per class.
+	 *
+	 * Entries remember the class weakly and are resolved again when the class was garbage collected, so a new
+	 * class at the same address never sees a stale path. Lookups may come from any thread.
+	 */
+	class BlueprintCache
+	{
+	public:
+		/**
+		 * \brief Blueprint'<path>' of the class, the same string GetClassBlueprint built before the cache
+		 */
+		FString GetClassBlueprint(UClass* the_class);
+
+		/**
+		 * \brief Class blueprint without `Default__`, what GetBlueprint returns for objects of the class
+		 */
+		FString GetObjectBlueprint(UClass* the_class);
+
+		/**
+		 * \brief Class blueprint as FName, NAME_None if the class has no blueprint
+		 */
+		FName GetClassBlueprintName(UClass* the_class);
+
+		/**
+		 * \brief True if `the_class` is the class with the object blueprint `blueprint`
+		 */
+		bool IsBlueprint(UClass* the_class, const FString& blueprint);
+
+	private:
+		struct Entry
+		{
+			WeakClass weak_class;
+			FString class_blueprint;
+			FString object_blueprint;
+			FName name;
+		};
+
+		static FString ResolveClassBlueprint(UClass* the_class);
+
+		// Returns a copy, the entry may be replaced by another thread once the lock is released
+		Entry Find(UClass* the_class);
+
+		std::unordered_map<UClass*, Entry> by_class_;
+		std::unordered_map<const FString, WeakClass, FStringHash, FStringEqual> by_blueprint_;
+		std::shared_mutex mutex_;
+	};
+} // namespace AsaApi
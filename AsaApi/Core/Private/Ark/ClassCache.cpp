@@ -0,0 +1,67 @@
+#include "ClassCache.h"
+
+#include <Logger/Logger.h>
+
+#include <mutex>
+
+namespace AsaApi
+{
+	UClass* ClassCache::LoadClass(const FString& blueprint)
+	{
+		if (blueprint.IsEmpty())
+			return nullptr;
+
+		bool collected = false;
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+
+			const auto iter = classes_.find(blueprint);
+			if (iter != classes_.end())
+			{
+				if (UClass* the_class = iter->second.Get())
+				{
+					++hits_;
+					return the_class;
+				}
+
+				collected = true;
+			}
+		}
+
+		++misses_;
+		if (collected)
+			++reloads_;
+
+		UClass* the_class = UVictoryCore::BPLoadClass(blueprint);
+		if (!the_class)
+		{
+			++failed_loads_;
+			return nullptr;
+		}
+
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		classes_[blueprint] = WeakClass(the_class);
+
+		return the_class;
+	}
+
+	int ClassCache::Preload(const TArray<FString>& blueprints)
+	{
+		int loaded = 0;
+		for (const FString& blueprint : blueprints)
+		{
+			if (LoadClass(blueprint))
+				++loaded;
+			else
+				Log::GetLog()->warn("({}) Could not load {}", __FUNCTION__, blueprint.ToString());
+		}
+
+		return loaded;
+	}
+
+	ClassCache::Stats ClassCache::GetStats()
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return Stats{hits_, misses_, failed_loads_, reloads_, classes_.size()};
+	}
+} // namespace AsaApi
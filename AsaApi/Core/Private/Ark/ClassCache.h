@@ -0,0 +1,54 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Classes loaded by blueprint path, loaded once and then looked up.
+	 *
+	 * Classes are held weakly and checked on every hit, a collected class is loaded again. Lookups may come from any
+	 * thread, loading a class that is not cached calls into the game and belongs on the game thread.
+	 */
+	class ClassCache
+	{
+	public:
+		struct Stats
+		{
+			uint64_t hits;
+			uint64_t misses;
+			uint64_t failed_loads;
+			uint64_t reloads;
+			size_t entries;
+		};
+
+		/**
+		 * \brief Returns the class of `blueprint`, nullptr if it cannot be loaded. Failed loads are not cached.
+		 */
+		UClass* LoadClass(const FString& blueprint);
+
+		/**
+		 * \brief Loads all blueprints, those that fail are logged
+		 * \return Number of classes that were loaded
+		 */
+		int Preload(const TArray<FString>& blueprints);
+
+		Stats GetStats();
+
+	private:
+		std::unordered_map<const FString, WeakClass, FStringHash, FStringEqual> classes_;
+		std::shared_mutex mutex_;
+
+		std::atomic<uint64_t> hits_{0};
+		std::atomic<uint64_t> misses_{0};
+		std::atomic<uint64_t> failed_loads_{0};
+		std::atomic<uint64_t> reloads_{0};
+	};
+} // namespace AsaApi
@@ -0,0 +1,89 @@
+#include "ClassHierarchy.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace AsaApi
+{
+	ClassHierarchy::Entry ClassHierarchy::Build(UClass* the_class)
+	{
+		Entry entry;
+		entry.weak_class = WeakClass(the_class);
+
+		for (UStruct* ancestor = the_class; ancestor != nullptr; ancestor = ancestor->SuperStructField())
+			entry.ancestors.push_back(static_cast<UClass*>(ancestor));
+
+		std::reverse(entry.ancestors.begin(), entry.ancestors.end());
+		return entry;
+	}
+
+	const ClassHierarchy::Entry* ClassHierarchy::FindLive(UClass* the_class) const
+	{
+		const auto iter = by_class_.find(the_class);
+		return iter != by_class_.end() && iter->second.weak_class.Get() == the_class ? &iter->second : nullptr;
+	}
+
+	void ClassHierarchy::Store(Entry entry)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+
+		by_class_.insert_or_assign(entry.weak_class.GetRaw(), std::move(entry));
+
+		// Collected classes are only noticed on lookup, drop them once the map has grown enough to be worth a pass
+		if (by_class_.size() >= sweep_at_)
+		{
+			std::erase_if(by_class_, [](const auto& item) { return item.second.weak_class.Get() == nullptr; });
+			sweep_at_ = std::max<size_t>(1024, by_class_.size() * 2);
+		}
+	}
+
+	bool ClassHierarchy::IsChildOf(UClass* the_class, UClass* base)
+	{
+		if (!the_class || !base)
+			return false;
+
+		if (the_class == base)
+			return true;
+
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+
+			const Entry* entry = FindLive(the_class);
+			const Entry* base_entry = FindLive(base);
+			if (entry && base_entry)
+			{
+				const size_t depth = base_entry->ancestors.size() - 1;
+				return depth < entry->ancestors.size() && entry->ancestors[depth] == base;
+			}
+		}
+
+		// Built without holding the lock, both classes are alive because the caller holds them
+		const Entry entry = Build(the_class);
+		const Entry base_entry = Build(base);
+
+		const size_t depth = base_entry.ancestors.size() - 1;
+		const bool is_child = depth < entry.ancestors.size() && entry.ancestors[depth] == base;
+
+		Store(entry);
+		Store(base_entry);
+
+		return is_child;
+	}
+
+	bool ClassHierarchy::IsKnown(UClass* the_class)
+	{
+		if (!the_class)
+			return false;
+
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return FindLive(the_class) != nullptr;
+	}
+
+	void ClassHierarchy::Add(UClass* the_class)
+	{
+		if (!the_class || IsKnown(the_class))
+			return;
+
+		Store(Build(the_class));
+	}
+} // namespace AsaApi
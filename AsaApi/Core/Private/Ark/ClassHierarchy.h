@@ -0,0 +1,59 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Superclass chains of classes, resolved once per class so IsChildOf is a single index compare.
+	 *
+	 * Every entry stores the depth of its class and all its ancestors from UObject down to the class itself. A class
+	 * is a child of `base` if its ancestor at the depth of `base` is `base`. Entries remember the class weakly and
+	 * are rebuilt when the class was garbage collected, so a new class at the same address never inherits a stale
+	 * chain. Lookups may come from any thread.
+	 */
+	class ClassHierarchy
+	{
+	public:
+		/**
+		 * \brief Same result as UStruct::IsChildOf without calling into the game once both classes were seen
+		 */
+		bool IsChildOf(UClass* the_class, UClass* base);
+
+		/**
+		 * \brief True if the class has a live entry. Never dereferences `the_class`, it may have been collected.
+		 */
+		bool IsKnown(UClass* the_class);
+
+		/**
+		 * \brief Adds an entry for a class that is known to be alive
+		 */
+		void Add(UClass* the_class);
+
+	private:
+		struct Entry
+		{
+			WeakClass weak_class;
+
+			// ancestors[0] is the root class, ancestors[depth] the class itself
+			std::vector<UClass*> ancestors;
+		};
+
+		static Entry Build(UClass* the_class);
+
+		// Expects the lock to be held
+		const Entry* FindLive(UClass* the_class) const;
+
+		void Store(Entry entry);
+
+		std::unordered_map<UClass*, Entry> by_class_;
+		size_t sweep_at_{1024};
+		std::shared_mutex mutex_;
+	};
+} // namespace AsaApi
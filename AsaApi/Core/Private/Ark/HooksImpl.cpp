@@ -78,6 +78,8 @@ namespace AsaApi
 
 	void Hook_UWorld_Tick(DWORD64 world, DWORD64 tick_type, float delta_seconds)
 	{
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).NewSpatialQueryTick();
+
 		Commands* command = dynamic_cast<Commands*>(API::game_api->GetCommands().get());
 		if (command)
 			command->CheckOnTickCallbacks(delta_seconds);
@@ -93,11 +95,11 @@ namespace AsaApi
 
 		AShooterGameMode_InitGame_original(a_shooter_game_mode, map_name, options, error_message);
 
+		const FString world_data_blueprint(L"Blueprint'/Script/ShooterGame.PrimalPersistentWorldData'");
 		const auto& actors = AsaApi::GetApiUtils().GetWorld()->PersistentLevelField().Get()->ActorsField();
 		for (auto actor : actors)
 		{
-			FString bp = AsaApi::GetApiUtils().GetBlueprint(actor);
-			if (bp.Equals("Blueprint'/Script/ShooterGame.PrimalPersistentWorldData'"))
+			if (AsaApi::IApiUtils::IsBlueprint(actor, world_data_blueprint))
 			{
 				if (actor->TargetingTeamField() == 0)
 					actor->TargetingTeamField() = a_shooter_game_mode->ServerIDField();
@@ -161,6 +163,8 @@ namespace AsaApi
 		Commands* command = dynamic_cast<Commands*>(API::game_api->GetCommands().get());
 		if (command)
 			command->CheckOnTimerCallbacks();
+
+		dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).RefreshPlayerControllers();
 		
 		API::PluginManager::DetectPluginChangesTimerCallback(); // We call this here to avoid UnknownModule crashes
 
@@ -171,6 +175,7 @@ namespace AsaApi
     {
         AShooterGameMode_BeginPlay_original(_AShooterGameMode);
         dynamic_cast<ApiUtils&>(*API::game_api->GetApiUtils()).SetStatus(ServerStatus::Ready);
+        API::PluginManager::Get().OnServerReady();
         
 		std::uint64_t mask = 0;
 
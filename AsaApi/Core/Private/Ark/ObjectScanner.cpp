@@ -0,0 +1,239 @@
+#include "ObjectScanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AsaApi
+{
+	namespace
+	{
+		template <typename T>
+		T Read(const void* base, size_t offset)
+		{
+			return *reinterpret_cast<const T*>(reinterpret_cast<const char*>(base) + offset);
+		}
+
+		// Two bits per class, the low one is set once the class was checked and the high one if it matched
+		class ClassBitmap
+		{
+		public:
+			explicit ClassBitmap(int size)
+				: size_(size), words_((static_cast<size_t>(size) + 31) / 32)
+			{
+			}
+
+			bool Contains(int index) const { return index >= 0 && index < size_; }
+
+			uint64_t Get(int index) const
+			{
+				return (words_[index / 32].load(std::memory_order_relaxed) >> (index % 32 * 2)) & 3;
+			}
+
+			// Workers racing on the same class compute the same bits, fetch_or keeps the neighbours intact
+			void Set(int index, bool matches)
+			{
+				words_[index / 32].fetch_or(static_cast<uint64_t>(matches ? 3 : 1) << (index % 32 * 2), std::memory_order_relaxed);
+			}
+
+		private:
+			int size_;
+			std::vector<std::atomic<uint64_t>> words_;
+		};
+
+		// Threads are started on the first scan and stay parked between scans, a scan only hands out its job
+		class WorkerPool
+		{
+		public:
+			static WorkerPool& Get()
+			{
+				// Never destroyed, joining threads while the module unloads would deadlock on the loader lock
+				static WorkerPool* pool = new WorkerPool((std::max)(std::thread::hardware_concurrency(), 1u) - 1);
+				return *pool;
+			}
+
+			unsigned GetWorkerCount() const { return worker_count_; }
+
+			// Runs `job` on the calling thread and on `helpers` workers, returns once all of them are done
+			void Run(const std::function<void()>& job, unsigned helpers)
+			{
+				std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					job_ = &job;
+					helpers_ = (std::min)(helpers, worker_count_);
+					pending_ = helpers_;
+					++generation_;
+				}
+
+				wake_.notify_all();
+
+				job();
+
+				std::unique_lock<std::mutex> lock(mutex_);
+				done_.wait(lock, [this] { return pending_ == 0; });
+				job_ = nullptr;
+			}
+
+		private:
+			explicit WorkerPool(unsigned worker_count)
+				: worker_count_(worker_count)
+			{
+				for (unsigned i = 0; i < worker_count_; ++i)
+				{
+					std::thread([this, i] { Work(i); }).detach();
+				}
+			}
+
+			void Work(unsigned index)
+			{
+				uint64_t seen = 0;
+
+				for (;;)
+				{
+					const std::function<void()>* job;
+
+					{
+						std::unique_lock<std::mutex> lock(mutex_);
+						wake_.wait(lock, [&] { return generation_ != seen; });
+						seen = generation_;
+
+						if (index >= helpers_)
+							continue;
+
+						job = job_;
+					}
+
+					(*job)();
+
+					{
+						std::lock_guard<std::mutex> lock(mutex_);
+						if (--pending_ == 0)
+							done_.notify_one();
+					}
+				}
+			}
+
+			const unsigned worker_count_;
+
+			std::mutex run_mutex_; // One scan at a time
+			std::mutex mutex_;
+			std::condition_variable wake_;
+			std::condition_variable done_;
+			const std::function<void()>* job_{nullptr};
+			unsigned helpers_{0};
+			unsigned pending_{0};
+			uint64_t generation_{0};
+		};
+	} // namespace
+
+	const ObjectScanner::Layout& ObjectScanner::GetGameLayout()
+	{
+		static const Layout layout{
+			static_cast<size_t>(GetAddress(nullptr, "UObjectBase.ClassPrivate")),
+			static_cast<size_t>(GetAddress(nullptr, "UObjectBase.InternalIndex")),
+			static_cast<size_t>(GetAddress(nullptr, "UStruct.SuperStruct"))
+		};
+
+		return layout;
+	}
+
+	void ObjectScanner::Scan(const FChunkedFixedUObjectArray& objects, const Layout& layout, UClass* the_class,
+		bool include_subclasses, TArray<UObject*>& found, unsigned thread_count)
+	{
+		found.Reset();
+
+		if (!the_class || objects.NumElements <= 0)
+			return;
+
+		constexpr int ElementsPerChunk = FChunkedFixedUObjectArray::ElementsPerChunk;
+
+		const int count = objects.NumElements;
+		const int chunk_count = (std::min)((count + ElementsPerChunk - 1) / ElementsPerChunk, objects.NumChunks);
+
+		ClassBitmap bitmap(include_subclasses ? count : 0);
+
+		const auto matches = [&](const void* object_class)
+		{
+			if (object_class == the_class)
+				return true;
+
+			if (!include_subclasses || !object_class)
+				return false;
+
+			const int index = Read<int>(object_class, layout.index_offset);
+			const bool cached = bitmap.Contains(index);
+			if (cached)
+			{
+				const uint64_t bits = bitmap.Get(index);
+				if (bits != 0)
+					return bits == 3;
+			}
+
+			bool derived = false;
+			for (const void* super = Read<const void*>(object_class, layout.super_offset); super != nullptr;
+				super = Read<const void*>(super, layout.super_offset))
+			{
+				if (super == the_class)
+				{
+					derived = true;
+					break;
+				}
+			}
+
+			if (cached)
+				bitmap.Set(index, derived);
+
+			return derived;
+		};
+
+		// One result list per chunk keeps the object array order without locking
+		std::vector<std::vector<UObject*>> chunk_results(chunk_count);
+		std::atomic<int> next_chunk{0};
+
+		const std::function<void()> scan = [&]()
+		{
+			for (int chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+			{
+				const FUObjectItem* items = objects.Objects[chunk];
+				if (!items)
+					continue;
+
+				const int items_in_chunk = (std::min)(ElementsPerChunk, count - chunk * ElementsPerChunk);
+				std::vector<UObject*>& results = chunk_results[chunk];
+
+				for (int i = 0; i < items_in_chunk; ++i)
+				{
+					UObject* object = items[i].Object;
+					if (object && matches(Read<const void*>(object, layout.class_offset)))
+						results.push_back(object);
+				}
+			}
+		};
+
+		WorkerPool& pool = WorkerPool::Get();
+
+		if (thread_count == 0)
+			thread_count = pool.GetWorkerCount() + 1;
+		thread_count = (std::min)(thread_count, static_cast<unsigned>(chunk_count));
+
+		pool.Run(scan, thread_count > 0 ? thread_count - 1 : 0);
+
+		size_t total = 0;
+		for (const auto& results : chunk_results)
+			total += results.size();
+
+		found.Reserve(static_cast<int>(total));
+		for (const auto& results : chunk_results)
+		{
+			for (UObject* object : results)
+				found.Add(object);
+		}
+	}
+} // namespace AsaApi
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Read-only scan of GUObjectArray for the objects of a class.
+	 *
+	 * The 64K element chunks are split between the calling thread and a pool of parked worker threads, called from
+	 * the game thread that is a safe point where garbage collection cannot run. Whether a class derives from the searched
+	 * class is decided once per class and shared between the workers through a bitmap indexed by the class's
+	 * object index, so deep hierarchies are walked once instead of once per object.
+	 */
+	class ObjectScanner
+	{
+	public:
+		// Field offsets read on every object, resolved once instead of through the offset map
+		struct Layout
+		{
+			size_t class_offset;
+			size_t index_offset;
+			size_t super_offset;
+		};
+
+		static const Layout& GetGameLayout();
+
+		/**
+		 * \brief Replaces the contents of `found` with the matching objects in object array order
+		 * \param objects Object table, GUObjectArray's for the game
+		 * \param layout Offsets of the class, object index and superclass fields
+		 * \param the_class Searched class
+		 * \param include_subclasses Also return objects of classes derived from `the_class`
+		 * \param thread_count Threads including the caller, 0 for one per hardware thread. Capped at the pool size.
+		 */
+		static void Scan(const FChunkedFixedUObjectArray& objects, const Layout& layout, UClass* the_class,
+			bool include_subclasses, TArray<UObject*>& found, unsigned thread_count = 0);
+	};
+} // namespace AsaApi
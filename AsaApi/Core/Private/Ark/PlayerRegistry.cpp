@@ -0,0 +1,245 @@
+#include "PlayerRegistry.h"
+
+#include <IApiUtils.h>
+
+#include <algorithm>
+
+namespace AsaApi
+{
+	namespace
+	{
+		template <typename Map, typename Key>
+		void EraseIfOwned(Map& map, const Key& key, AShooterPlayerController* player_controller)
+		{
+			auto iter = map.find(key);
+			if (iter != map.end() && iter->second == player_controller)
+				map.erase(iter);
+		}
+	} // namespace
+
+	PlayerRegistry::Entry PlayerRegistry::Read(AShooterPlayerController* player_controller)
+	{
+		Entry entry;
+		entry.object = WeakObject<AShooterPlayerController>(player_controller);
+		entry.eos_id = IApiUtils::GetEOSIDFromController(player_controller);
+		entry.player_id = IApiUtils::GetPlayerID(player_controller);
+		entry.character_name = IApiUtils::GetCharacterName(player_controller);
+		entry.tribe_id = IApiUtils::GetTribeID(player_controller);
+
+		if (player_controller->PlayerStateField())
+			entry.platform_name = player_controller->PlayerStateField()->PlayerNamePrivateField();
+
+		return entry;
+	}
+
+	std::wstring PlayerRegistry::MakeNameKey(const FString& name)
+	{
+		return std::wstring(*name.ToLower());
+	}
+
+	void PlayerRegistry::Index(AShooterPlayerController* player_controller, const Entry& entry)
+	{
+		if (!entry.eos_id.IsEmpty())
+			by_eos_id_[entry.eos_id] = player_controller;
+
+		if (entry.player_id != 0)
+			by_player_id_[entry.player_id] = player_controller;
+
+		if (!entry.platform_name.IsEmpty())
+			by_platform_name_[entry.platform_name] = player_controller;
+
+		if (!entry.character_name.IsEmpty())
+			by_character_name_.emplace(MakeNameKey(entry.character_name), player_controller);
+
+		by_tribe_id_[entry.tribe_id].push_back(player_controller);
+	}
+
+	void PlayerRegistry::Unindex(AShooterPlayerController* player_controller, const Entry& entry)
+	{
+		if (!entry.eos_id.IsEmpty())
+			EraseIfOwned(by_eos_id_, entry.eos_id, player_controller);
+
+		if (entry.player_id != 0)
+			EraseIfOwned(by_player_id_, entry.player_id, player_controller);
+
+		if (!entry.platform_name.IsEmpty())
+			EraseIfOwned(by_platform_name_, entry.platform_name, player_controller);
+
+		if (!entry.character_name.IsEmpty())
+		{
+			auto [begin, end] = by_character_name_.equal_range(MakeNameKey(entry.character_name));
+			for (auto iter = begin; iter != end; ++iter)
+			{
+				if (iter->second == player_controller)
+				{
+					by_character_name_.erase(iter);
+					break;
+				}
+			}
+		}
+
+		auto tribe = by_tribe_id_.find(entry.tribe_id);
+		if (tribe != by_tribe_id_.end())
+		{
+			std::erase(tribe->second, player_controller);
+			if (tribe->second.empty())
+				by_tribe_id_.erase(tribe);
+		}
+	}
+
+	void PlayerRegistry::Add(AShooterPlayerController* player_controller)
+	{
+		if (!player_controller)
+			return;
+
+		Entry entry = Read(player_controller);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto iter = players_.find(player_controller);
+		if (iter != players_.end())
+		{
+			Unindex(player_controller, iter->second);
+			iter->second = std::move(entry);
+		}
+		else
+		{
+			iter = players_.emplace(player_controller, std::move(entry)).first;
+		}
+
+		Index(player_controller, iter->second);
+	}
+
+	void PlayerRegistry::Remove(AShooterPlayerController* player_controller)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto iter = players_.find(player_controller);
+		if (iter == players_.end())
+			return;
+
+		Unindex(player_controller, iter->second);
+		players_.erase(iter);
+	}
+
+	void PlayerRegistry::Refresh()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (auto iter = players_.begin(); iter != players_.end();)
+		{
+			AShooterPlayerController* player_controller = iter->first;
+			Entry& entry = iter->second;
+
+			if (!entry.object.Get())
+			{
+				Unindex(player_controller, entry);
+				iter = players_.erase(iter);
+				continue;
+			}
+
+			++iter;
+
+			const uint64 player_id = IApiUtils::GetPlayerID(player_controller);
+			const int tribe_id = IApiUtils::GetTribeID(player_controller);
+			const FString character_name = IApiUtils::GetCharacterName(player_controller);
+			const FString platform_name = player_controller->PlayerStateField()
+				? player_controller->PlayerStateField()->PlayerNamePrivateField()
+				: FString();
+
+			if (player_id == entry.player_id && tribe_id == entry.tribe_id
+				&& character_name.Equals(entry.character_name, ESearchCase::CaseSensitive)
+				&& platform_name.Equals(entry.platform_name, ESearchCase::CaseSensitive))
+			{
+				continue;
+			}
+
+			Unindex(player_controller, entry);
+			entry.player_id = player_id;
+			entry.tribe_id = tribe_id;
+			entry.character_name = character_name;
+			entry.platform_name = platform_name;
+			Index(player_controller, entry);
+		}
+	}
+
+	bool PlayerRegistry::Contains(AShooterPlayerController* player_controller) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return players_.contains(player_controller);
+	}
+
+	int PlayerRegistry::Num() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return static_cast<int>(players_.size());
+	}
+
+	AShooterPlayerController* PlayerRegistry::FindByEOSID(const FString& eos_id) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto iter = by_eos_id_.find(eos_id);
+		return iter != by_eos_id_.end() ? iter->second : nullptr;
+	}
+
+	AShooterPlayerController* PlayerRegistry::FindByPlayerID(uint64 player_id) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto iter = by_player_id_.find(player_id);
+		return iter != by_player_id_.end() ? iter->second : nullptr;
+	}
+
+	AShooterPlayerController* PlayerRegistry::FindByPlatformName(const FString& platform_name) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto iter = by_platform_name_.find(platform_name);
+		return iter != by_platform_name_.end() ? iter->second : nullptr;
+	}
+
+	TArray<AShooterPlayerController*> PlayerRegistry::FindByCharacterName(const FString& character_name,
+		ESearchCase::Type search, bool full_match) const
+	{
+		TArray<AShooterPlayerController*> found_players;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const std::wstring key = MakeNameKey(character_name);
+		const auto matches = [&](const std::wstring& candidate)
+		{
+			return full_match ? candidate == key : candidate.compare(0, key.size(), key) == 0;
+		};
+
+		for (auto iter = by_character_name_.lower_bound(key); iter != by_character_name_.end() && matches(iter->first); ++iter)
+		{
+			if (search == ESearchCase::CaseSensitive)
+			{
+				const FString& name = players_.at(iter->second).character_name;
+				if (full_match ? !name.Equals(character_name, search) : !name.StartsWith(character_name, search))
+					continue;
+			}
+
+			found_players.Add(iter->second);
+		}
+
+		return found_players;
+	}
+
+	TArray<AShooterPlayerController*> PlayerRegistry::FindByTribeID(int tribe_id) const
+	{
+		TArray<AShooterPlayerController*> found_players;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto iter = by_tribe_id_.find(tribe_id);
+		if (iter != by_tribe_id_.end())
+		{
+			for (AShooterPlayerController* player_controller : iter->second)
+				found_players.Add(player_controller);
+		}
+
+		return found_players;
+	}
+} // namespace AsaApi
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Online players indexed by EOS id, player data ID, platform name, character name and tribe.
+	 *
+	 * Players are added by the login and possess hooks and removed by the logout hook. Names and tribes can change
+	 * while a player stays possessed, `Refresh` picks those changes up from the game timer and drops controllers that
+	 * were destroyed without a logout.
+	 *
+	 * All members lock the registry, lookups can come from any thread.
+	 */
+	class PlayerRegistry
+	{
+	public:
+		void Add(AShooterPlayerController* player_controller);
+		void Remove(AShooterPlayerController* player_controller);
+
+		/**
+		 * \brief Re-reads the player data IDs, names and tribes of all players and updates their index entries.
+		 * Controllers that no longer exist are removed instead of read.
+		 */
+		void Refresh();
+
+		bool Contains(AShooterPlayerController* player_controller) const;
+		int Num() const;
+
+		AShooterPlayerController* FindByEOSID(const FString& eos_id) const;
+		AShooterPlayerController* FindByPlayerID(uint64 player_id) const;
+
+		/**
+		 * \brief Case insensitive, like the FString comparison the scan used
+		 */
+		AShooterPlayerController* FindByPlatformName(const FString& platform_name) const;
+
+		/**
+		 * \brief Exact or prefix match, O(log n) plus the number of matches
+		 */
+		TArray<AShooterPlayerController*> FindByCharacterName(const FString& character_name, ESearchCase::Type search,
+			bool full_match) const;
+
+		TArray<AShooterPlayerController*> FindByTribeID(int tribe_id) const;
+
+	private:
+		struct Entry
+		{
+			WeakObject<AShooterPlayerController> object;
+			FString eos_id;
+			uint64 player_id{0};
+			FString platform_name;
+			FString character_name;
+			int tribe_id{0};
+		};
+
+		static Entry Read(AShooterPlayerController* player_controller);
+
+		// Character name keys are lower case, the case sensitive searches filter the candidates afterwards
+		static std::wstring MakeNameKey(const FString& name);
+
+		void Index(AShooterPlayerController* player_controller, const Entry& entry);
+		void Unindex(AShooterPlayerController* player_controller, const Entry& entry);
+
+		mutable std::mutex mutex_;
+		std::unordered_map<AShooterPlayerController*, Entry> players_;
+
+		std::unordered_map<const FString, AShooterPlayerController*, FStringHash, FStringEqual> by_eos_id_;
+		std::unordered_map<uint64, AShooterPlayerController*> by_player_id_;
+		std::unordered_map<const FString, AShooterPlayerController*, FStringHashIgnoreCase, FStringEqualIgnoreCase> by_platform_name_;
+		std::multimap<std::wstring, AShooterPlayerController*> by_character_name_;
+		std::unordered_map<int, std::vector<AShooterPlayerController*>> by_tribe_id_;
+	};
+} // namespace AsaApi
@@ -0,0 +1,74 @@
+#include "SpatialQueries.h"
+
+#include <IApiUtils.h>
+
+#include <functional>
+
+namespace AsaApi
+{
+	size_t SpatialQueries::KeyHash::operator()(const Key& key) const
+	{
+		size_t hash = std::hash<double>{}(key.location.X);
+		hash = hash * 31 + std::hash<double>{}(key.location.Y);
+		hash = hash * 31 + std::hash<double>{}(key.location.Z);
+		hash = hash * 31 + std::hash<float>{}(key.radius);
+		return hash * 31 + static_cast<size_t>(key.group);
+	}
+
+	const std::vector<WeakObject<AActor>>& SpatialQueries::Find(UWorld* world, const Key& key)
+	{
+		auto iter = results_.find(key);
+		if (iter != results_.end())
+			return iter->second;
+
+		// The native call constructs the result in place, it has to be handed an empty array
+		TArray<AActor*> found;
+		FVector location = key.location;
+		UVictoryCore::ServerOctreeOverlapActors(&found, world, &location, key.radius, key.group, true);
+
+		// Garbage collection can run between two batches of the same tick, cached actors are checked before use
+		std::vector<WeakObject<AActor>> actors;
+		actors.reserve(found.Num());
+		for (AActor* actor : found)
+		{
+			if (actor)
+				actors.emplace_back(actor);
+		}
+
+		return results_.emplace(key, std::move(actors)).first->second;
+	}
+
+	void SpatialQueries::Run(UWorld* world, ActorsInRangeQuery* queries, int count)
+	{
+		if (!world)
+			return;
+
+		for (int i = 0; i < count; ++i)
+		{
+			ActorsInRangeQuery& query = queries[i];
+			if (!query.actors)
+				continue;
+
+			const std::vector<WeakObject<AActor>>& found = Find(world, Key{query.location, query.radius, query.group});
+
+			query.actors->Reset(static_cast<int>(found.size()));
+
+			ignored_.clear();
+			if (query.ignores)
+				ignored_.insert(query.ignores->begin(), query.ignores->end());
+
+			// The result may be from earlier in the tick, actors collected or destroyed since then are left out
+			for (const WeakObject<AActor>& weak_actor : found)
+			{
+				AActor* actor = weak_actor.Get();
+				if (actor && !actor->bActorIsBeingDestroyed()() && !ignored_.contains(actor))
+					query.actors->Add(actor);
+			}
+		}
+	}
+
+	void SpatialQueries::NewTick()
+	{
+		results_.clear();
+	}
+} // namespace AsaApi
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+#include "WeakObject.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace AsaApi
+{
+	struct ActorsInRangeQuery;
+
+	/**
+	 * \brief Octree overlap queries answered once per tick.
+	 *
+	 * Queries with the same location, radius and group share one ServerOctreeOverlapActors call until the next world
+	 * tick, later callers get a copy of the first result in their own buffer. Cached actors are weak references,
+	 * actors collected or being destroyed since the query are filtered while copying. Game thread only.
+	 */
+	class SpatialQueries
+	{
+	public:
+		void Run(UWorld* world, ActorsInRangeQuery* queries, int count);
+
+		/**
+		 * \brief Drops the results of the previous tick. Called by the UWorld::Tick hook.
+		 */
+		void NewTick();
+
+	private:
+		struct Key
+		{
+			FVector location;
+			float radius;
+			EServerOctreeGroup::Type group;
+
+			bool operator==(const Key& other) const
+			{
+				return location.X == other.location.X && location.Y == other.location.Y && location.Z == other.location.Z
+					&& radius == other.radius && group == other.group;
+			}
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		const std::vector<WeakObject<AActor>>& Find(UWorld* world, const Key& key);
+
+		std::unordered_map<Key, std::vector<WeakObject<AActor>>, KeyHash> results_;
+
+		// Kept between queries so the buckets are only allocated once
+		std::unordered_set<AActor*> ignored_;
+	};
+} // namespace AsaApi
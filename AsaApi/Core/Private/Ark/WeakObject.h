@@ -0,0 +1,57 @@
+#pragma once
+
+#include <API/ARK/Ark.h>
+
+namespace AsaApi
+{
+	/**
+	 * \brief Weak reference to a UObject that is checked against GUObjectArray without calling into the game.
+	 *
+	 * The slot index and serial number are taken once through FWeakObjectPtr, later checks only read the object
+	 * array. A collected object fails the check even if a new object was allocated at the same address.
+	 */
+	template <typename T>
+	class WeakObject
+	{
+	public:
+		WeakObject() = default;
+
+		explicit WeakObject(T* object)
+			: object_(object)
+		{
+			if (object)
+			{
+				FWeakObjectPtr weak;
+				weak = static_cast<const UObject*>(object);
+				index_ = weak.ObjectIndex;
+				serial_number_ = weak.ObjectSerialNumber;
+			}
+		}
+
+		/**
+		 * \brief Returns the object, nullptr if it was garbage collected
+		 */
+		T* Get() const
+		{
+			static FUObjectArray& object_array = Globals::GUObjectArray()();
+
+			if (!object_ || index_ < 0 || index_ >= object_array.ObjObjects.NumElements)
+				return nullptr;
+
+			const FUObjectItem& item = object_array.ObjObjects.GetByIndex(index_);
+			return item.Object == static_cast<UObject*>(object_) && item.SerialNumber == serial_number_ ? object_ : nullptr;
+		}
+
+		/**
+		 * \brief The object the reference was made for, whether it is alive or not
+		 */
+		T* GetRaw() const { return object_; }
+
+	private:
+		T* object_{nullptr};
+		int index_{-1};
+		int serial_number_{0};
+	};
+
+	using WeakClass = WeakObject<UClass>;
+} // namespace AsaApi
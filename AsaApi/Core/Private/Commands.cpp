@@ -2,38 +2,46 @@
 
 #include "IBaseApi.h"
 
+#include <intrin.h>
+
 namespace AsaApi
 {
 	void Commands::AddChatCommand(const FString& command,
 		const std::function<void(AShooterPlayerController*, FString*, int, int)>&callback)
 	{
-		chat_commands_.push_back(std::make_shared<ChatCommand>(command, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		chat_commands_.push_back(std::make_shared<ChatCommand>(command, callback, module));
 	}
 
 	void Commands::AddConsoleCommand(const FString& command,
 		const std::function<void(APlayerController*, FString*, bool)>& callback)
 	{
-		console_commands_.push_back(std::make_shared<ConsoleCommand>(command, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		console_commands_.push_back(std::make_shared<ConsoleCommand>(command, callback, module));
 	}
 
 	void Commands::AddRconCommand(const FString& command, const std::function<void(RCONClientConnection*, RCONPacket*, UWorld*)>& callback)
 	{
-		rcon_commands_.push_back(std::make_shared<RconCommand>(command, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		rcon_commands_.push_back(std::make_shared<RconCommand>(command, callback, module));
 	}
 
 	void Commands::AddOnTickCallback(const FString& id, const std::function<void(float)>& callback)
 	{
-		on_tick_callbacks_.push_back(std::make_shared<OnTickCallback>(id, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		on_tick_callbacks_.push_back(std::make_shared<OnTickCallback>(id, callback, module));
 	}
 
 	void Commands::AddOnTimerCallback(const FString& id, const std::function<void()>& callback)
 	{
-		on_timer_callbacks_.push_back(std::make_shared<OnTimerCallback>(id, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		on_timer_callbacks_.push_back(std::make_shared<OnTimerCallback>(id, callback, module));
 	}
 
 	void Commands::AddOnChatMessageCallback(const FString& id, const std::function<bool(AShooterPlayerController*, FString*, int, int, bool, bool)>& callback)
 	{
-		on_chat_message_callbacks_.push_back(std::make_shared<OnChatMessageCallback>(id, callback));
+		const HMODULE module = API::PluginProfiler::ModuleFromAddress(_ReturnAddress());
+		on_chat_message_callbacks_.push_back(std::make_shared<OnChatMessageCallback>(id, callback, module));
 	}
 
 	bool Commands::RemoveChatCommand(const FString& command)
@@ -68,19 +76,19 @@ namespace AsaApi
 
 	bool Commands::CheckChatCommands(AShooterPlayerController* shooter_player_controller, FString* message, int mode, int platform)
 	{
-		return CheckCommands<ChatCommand>(*message, chat_commands_, shooter_player_controller, message, mode, platform);
+		return CheckCommands<ChatCommand>(*message, chat_commands_, API::PluginProfiler::Category::ChatCommand, shooter_player_controller, message, mode, platform);
 	}
 
 	bool Commands::CheckConsoleCommands(APlayerController* a_player_controller, FString* cmd, bool write_to_log)
 	{
-		return CheckCommands<ConsoleCommand>(*cmd, console_commands_, a_player_controller, cmd, write_to_log);
+		return CheckCommands<ConsoleCommand>(*cmd, console_commands_, API::PluginProfiler::Category::ConsoleCommand, a_player_controller, cmd, write_to_log);
 	}
 
 	bool Commands::CheckRconCommands(RCONClientConnection* rcon_client_connection, RCONPacket* rcon_packet,
 		UWorld* u_world)
 	{
-		return CheckCommands<RconCommand>(rcon_packet->Body, rcon_commands_, rcon_client_connection, rcon_packet,
-			u_world);
+		return CheckCommands<RconCommand>(rcon_packet->Body, rcon_commands_, API::PluginProfiler::Category::RconCommand,
+			rcon_client_connection, rcon_packet, u_world);
 	}
 
 	void Commands::CheckOnTickCallbacks(float delta_seconds)
@@ -90,6 +98,7 @@ namespace AsaApi
 		{
 			if (data)
 			{
+				API::PluginProfiler::Scope scope(data->module, API::PluginProfiler::Category::Tick);
 				data->callback(delta_seconds);
 			}
 		}
@@ -102,6 +111,7 @@ namespace AsaApi
 		{
 			if (data)
 			{
+				API::PluginProfiler::Scope scope(data->module, API::PluginProfiler::Category::Timer);
 				data->callback();
 			}
 		}
@@ -120,6 +130,7 @@ namespace AsaApi
 		bool prevent_default = false;
 		for (const auto& data : tmp_chat_callbacks)
 		{
+			API::PluginProfiler::Scope scope(data->module, API::PluginProfiler::Category::ChatMessage);
 			prevent_default |= data->callback(player_controller, message, mode, platform, spam_check, command_executed);
 		}
 
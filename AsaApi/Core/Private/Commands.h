@@ -1,6 +1,9 @@
 #pragma once
 
 #include <ICommands.h>
+#include <API/Helpers/StringKernels.h>
+
+#include "PluginManager/PluginProfiler.h"
 
 #include <algorithm>
 #include <memory>
@@ -48,14 +51,16 @@ namespace AsaApi
 		template <typename T>
 		struct Command
 		{
-			Command(FString command, std::function<T> callback)
+			Command(FString command, std::function<T> callback, HMODULE module)
 				: command(std::move(command)),
-				callback(std::move(callback))
+				callback(std::move(callback)),
+				module(module)
 			{
 			}
 
 			FString command;
 			std::function<T> callback;
+			HMODULE module;
 		};
 
 		using ChatCommand = Command<void(AShooterPlayerController*, FString*, int, int)>;
@@ -86,22 +91,30 @@ namespace AsaApi
 		}
 
 		template <typename T, typename... Args>
-		bool CheckCommands(const FString& message, const std::vector<std::shared_ptr<T>>& commands, Args&&... args)
+		bool CheckCommands(const FString& message, const std::vector<std::shared_ptr<T>>& commands,
+			API::PluginProfiler::Category category, Args&&... args)
 		{
-			TArray<FString> parsed;
-			message.ParseIntoArray(parsed, L" ", true);
+			// The command is the first word of the message, it is matched in place instead of splitting the message
+			const TCHAR* begin = *message;
+			while (*begin == L' ')
+				++begin;
+
+			const TCHAR* end = begin;
+			while (*end != L'\0' && *end != L' ')
+				++end;
 
-			if (!parsed.IsValidIndex(0))
+			const int length = static_cast<int>(end - begin);
+			if (length == 0)
 			{
 				return false;
 			}
 
-			const FString command_text = parsed[0];
-
 			for (const auto& command : commands)
 			{
-				if (command_text.Compare(command->command, ESearchCase::IgnoreCase) == 0)
+				if (command->command.Len() == length
+					&& StringKernels::EqualsIgnoreCase(begin, *command->command, length))
 				{
+					API::PluginProfiler::Scope scope(command->module, category);
 					command->callback(std::forward<Args>(args)...);
 
 					return true;
@@ -10,8 +10,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
-#include <json.hpp>
-#include <Tools.h>
+#include <ConfigService.h>
 
 namespace
 {
@@ -400,14 +399,8 @@ namespace API
 
 		try
 		{
-			const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-			std::ifstream f(config_path);
-			if (f.is_open())
-			{
-				nlohmann::json cfg;
-				f >> cfg;
-				extended_debug_ = cfg["settings"].value("ExtendedDebug", false);
-			}
+			const auto config = ConfigService::Get().GetConfig();
+			extended_debug_ = ConfigService::GetSettings(config).value("ExtendedDebug", false);
 		}
 		catch (...) {}
 	}
@@ -475,10 +468,11 @@ namespace API
 
 		if (!ok)
 		{
+			// Limited per function, a plugin retrying one hook must not hide the failures of others
 			if (attachErr != NO_ERROR)
-				Log::GetLog()->error("[{}] Hook failed for {} (chain depth: {}, DetourAttach err={}, {})", ModuleName(hOwner), func_name, hook_vector.size(), attachErr, DescribeTransactionFailure(transaction));
+				LOG_LIMITED_KEYED(Log::GetLog(), spdlog::level::err, func_name, "[{}] Hook failed for {} (chain depth: {}, DetourAttach err={}, {})", ModuleName(hOwner), func_name, hook_vector.size(), attachErr, DescribeTransactionFailure(transaction));
 			else
-				Log::GetLog()->error("[{}] Hook failed for {} (chain depth: {}, {})", ModuleName(hOwner), func_name, hook_vector.size(), DescribeTransactionFailure(transaction));
+				LOG_LIMITED_KEYED(Log::GetLog(), spdlog::level::err, func_name, "[{}] Hook failed for {} (chain depth: {}, {})", ModuleName(hOwner), func_name, hook_vector.size(), DescribeTransactionFailure(transaction));
 			
 			*original = nullptr;
 			return false;
@@ -491,6 +485,47 @@ namespace API
 		return true;
 	}
 
+	bool Hooks::AttachDetours(const std::vector<std::pair<LPVOID*, LPVOID>>& detours)
+	{
+		std::unique_lock installLock(g_hookInstallMutex);
+
+		TransactionContext transaction;
+		LONG attachErr = NO_ERROR;
+		bool ok = false;
+
+		for (int attempt = 0; attempt < kTransactionRetryCount; ++attempt)
+		{
+			transaction.Reset();
+			transaction.attempts = static_cast<std::size_t>(attempt + 1);
+
+			bool attachSucceeded = true;
+			attachErr = NO_ERROR;
+
+			ok = RunTransaction([&]()
+				{
+					for (const auto& [original, detour] : detours)
+					{
+						attachErr = DetourAttach(original, detour);
+						if (attachErr != NO_ERROR)
+						{
+							attachSucceeded = false;
+							return;
+						}
+					}
+				}, transaction, &attachSucceeded);
+
+			if (ok || attempt + 1 >= kTransactionRetryCount || !ShouldRetryTransaction(transaction, attachErr))
+				break;
+
+			Sleep(kTransactionRetryDelayMs);
+		}
+
+		if (!ok)
+			Log::GetLog()->error("Detours failed (DetourAttach err={}, {})", attachErr, DescribeTransactionFailure(transaction));
+
+		return ok;
+	}
+
 	bool Hooks::DisableHook(const std::string& func_name, LPVOID detour)
 	{
 		const LPVOID target = Offsets::Get().GetAddress(func_name);
@@ -631,6 +666,21 @@ namespace API
 		return true;
 	}
 
+	std::vector<LPVOID> Hooks::GetHookTargets()
+	{
+		std::lock_guard snapLock(g_hookInstallMutex);
+
+		std::vector<LPVOID> targets;
+		targets.reserve(all_hooks_.size());
+		for (const auto& [func_name, hook_vec] : all_hooks_)
+		{
+			if (!hook_vec.empty())
+				targets.push_back(hook_vec.front()->target);
+		}
+
+		return targets;
+	}
+
 	void Hooks::DisableAllHooksFromModule(HMODULE hModule)
 	{
 		if (!hModule) return;
@@ -27,6 +27,18 @@ namespace API
 
 		void DisableAllHooksFromModule(HMODULE hModule);
 
+		/**
+		 * \brief Detours functions that are not part of the game symbols, e.g. CRT exports, in one transaction.
+		 * They stay installed for the lifetime of the process.
+		 * \param detours Pairs of pointer to the target (receives the trampoline) and detour
+		 */
+		bool AttachDetours(const std::vector<std::pair<LPVOID*, LPVOID>>& detours);
+
+		/**
+		 * \brief Addresses of the game functions that currently have at least one detour
+		 */
+		std::vector<LPVOID> GetHookTargets();
+
 	private:
 		struct Hook
 		{
@@ -1,36 +1,33 @@
 #include <Logger/Logger.h>
 
+#include <algorithm>
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 
+#include <ConfigService.h>
 #include <Tools.h>
 #include <json.hpp>
 
-std::string GetLogName()
-{
-	static std::string log_name("-1");
-	if (log_name == "-1")
-	{
-		const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{config_path};
-		if (!file.is_open())
-		{
-			log_name = "";
-			return "";
-		}
-
-		nlohmann::json config;
-		file >> config;
-		file.close();
+#include "Logging/AsyncLogSink.h"
+#include "Logging/FlightRecorderSink.h"
+#include "Logging/StructuredLogSink.h"
 
-		log_name = config["settings"].value("StaticLogPath", "");
-	}
+const nlohmann::json& GetLogSettings()
+{
+	// Sinks are only created at startup, later edits of config.json do not apply to them
+	static const API::ConfigService::Snapshot config = API::ConfigService::Get().GetConfig();
+	return API::ConfigService::GetSettings(config);
+}
 
-	return log_name;
+std::string GetLogName()
+{
+	return GetLogSettings().value("StaticLogPath", "");
 }
 
-std::vector<spdlog::sink_ptr>& GetLogSinks()
+std::vector<spdlog::sink_ptr> CreateLogSinks()
 {
-	static std::vector<spdlog::sink_ptr> sinks{
+	std::vector<spdlog::sink_ptr> sinks{
 		std::make_shared<spdlog::sinks::wincolor_stdout_sink_mt>(),
 		std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
 			!GetLogName().empty()
@@ -41,5 +38,215 @@ std::vector<spdlog::sink_ptr>& GetLogSinks()
 			1024 * 1024, 5)
 	};
 
+	try
+	{
+		const nlohmann::json logging = GetLogSettings().value("Logging", nlohmann::json::object());
+
+		if (logging.value("Async", false))
+		{
+			// Console and file writes move to a dedicated thread, callers only enqueue the formatted line
+			auto async_sink = std::make_shared<API::AsyncLogSink>(sinks,
+				logging.value("QueueSize", 8192),
+				API::AsyncLogSink::ParseOverflowPolicy(logging.value("OverflowPolicy", "Block")),
+				std::chrono::milliseconds(logging.value("FlushIntervalMs", 1000)));
+
+			API::AsyncLogSink::InstallCrashHandler(async_sink);
+
+			sinks = {async_sink};
+		}
+
+		// Written on the calling thread and outside of the async queue, so the last records survive any crash
+		const nlohmann::json flight_recorder = logging.value("FlightRecorder", nlohmann::json::object());
+		if (flight_recorder.value("Enable", false))
+		{
+			auto recorder = std::make_shared<API::FlightRecorderSink>(
+				API::Tools::GetCurrentDir() + "/logs/" + API::FlightRecorderSink::GetFileName(GetCurrentProcessId()).string(),
+				static_cast<uint64_t>(flight_recorder.value("SizeMB", 16)) * 1024 * 1024);
+
+			if (recorder->IsOpen())
+				sinks.push_back(std::move(recorder));
+		}
+
+		// Has its own writer thread, so it stays outside of the async queue as well
+		const nlohmann::json structured = logging.value("Structured", nlohmann::json::object());
+		if (structured.value("Enable", false))
+		{
+			sinks.push_back(std::make_shared<API::StructuredLogSink>(
+				API::Tools::GetCurrentDir() + "/logs",
+				"Events_" + std::to_string(GetCurrentProcessId()),
+				static_cast<uint64_t>(structured.value("MaxFileSizeMB", 64)) * 1024 * 1024,
+				structured.value("MaxFiles", 10)));
+		}
+	}
+	catch (const std::exception&)
+	{
+	}
+
 	return sinks;
 }
+
+std::vector<spdlog::sink_ptr>& GetLogSinks()
+{
+	static std::vector<spdlog::sink_ptr> sinks = CreateLogSinks();
+
+	return sinks;
+}
+
+void LogStructured(spdlog::logger* logger, spdlog::level::level_enum level, const std::string& message,
+                   const std::vector<API::LogField>& fields)
+{
+	std::string text = message;
+	for (const API::LogField& field : fields)
+	{
+		text += ' ';
+		text += field.key;
+		text += '=';
+		std::visit([&text](const auto& value)
+		{
+			using Type = std::decay_t<decltype(value)>;
+
+			if constexpr (std::is_same_v<Type, std::nullptr_t>)
+				text += "null";
+			else if constexpr (std::is_same_v<Type, bool>)
+				text += value ? "true" : "false";
+			else if constexpr (std::is_same_v<Type, std::string>)
+				text += value.find(' ') == std::string::npos ? value : '"' + value + '"';
+			else
+				text += fmt::format("{}", value);
+		}, field.value);
+	}
+
+	// The structured sink takes message and fields from the scope instead of the rendered text
+	API::StructuredLogSink::EventScope scope(message, fields);
+	logger->log(level, text.c_str());
+}
+
+namespace
+{
+	struct LoggerRegistry
+	{
+		std::mutex mutex;
+		std::vector<spdlog::logger*> loggers;
+		std::vector<LogRateLimiter*> limiters;
+		std::unordered_map<std::string, spdlog::level::level_enum> levels; // by logger name, "*" for all
+	};
+
+	LoggerRegistry& GetLoggerRegistry()
+	{
+		// Never destroyed, static Log instances of modules unregister during their own teardown
+		static auto* registry = []
+		{
+			auto* result = new LoggerRegistry;
+
+			try
+			{
+				const nlohmann::json levels = GetLogSettings().value("Logging", nlohmann::json::object())
+				                                               .value("Levels", nlohmann::json::object());
+				for (const auto& [name, value] : levels.items())
+				{
+					if (spdlog::level::level_enum level; Log::ParseLevel(value.get<std::string>(), level))
+						result->levels[name] = level;
+				}
+			}
+			catch (const std::exception&)
+			{
+			}
+
+			return result;
+		}();
+
+		return *registry;
+	}
+} // namespace
+
+void RegisterLogger(spdlog::logger* logger)
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	if (const auto level = registry.levels.find(logger->name()); level != registry.levels.end())
+		logger->set_level(level->second);
+	else if (const auto all = registry.levels.find("*"); all != registry.levels.end())
+		logger->set_level(all->second);
+
+	registry.loggers.push_back(logger);
+}
+
+void UnregisterLogger(spdlog::logger* logger)
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::erase(registry.loggers, logger);
+
+	for (LogRateLimiter* limiter : registry.limiters)
+	{
+		limiter->ForgetLogger(logger);
+	}
+}
+
+void RegisterLogRateLimiter(LogRateLimiter* limiter)
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	registry.limiters.push_back(limiter);
+}
+
+void UnregisterLogRateLimiter(LogRateLimiter* limiter)
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::erase(registry.limiters, limiter);
+}
+
+void ReportSuppressedLogLines()
+{
+	auto& registry = GetLoggerRegistry();
+
+	// Held while logging so a module cannot unload a limiter or its logger in between
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (LogRateLimiter* limiter : registry.limiters)
+	{
+		limiter->ReportSuppressed();
+	}
+}
+
+bool SetLoggerLevel(const std::string& name, spdlog::level::level_enum level)
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	if (name == "*")
+		registry.levels.clear();
+
+	registry.levels[name] = level;
+
+	bool found = false;
+	for (spdlog::logger* logger : registry.loggers)
+	{
+		if (name == "*" || logger->name() == name)
+		{
+			logger->set_level(level);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+std::vector<std::pair<std::string, spdlog::level::level_enum>> GetLoggerLevels()
+{
+	auto& registry = GetLoggerRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	std::vector<std::pair<std::string, spdlog::level::level_enum>> result;
+	for (const spdlog::logger* logger : registry.loggers)
+	{
+		result.emplace_back(logger->name(), logger->level());
+	}
+
+	return result;
+}
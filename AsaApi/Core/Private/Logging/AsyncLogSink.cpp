@@ -0,0 +1,288 @@
+#include "AsyncLogSink.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <Windows.h>
+
+namespace API
+{
+	namespace
+	{
+		std::atomic<AsyncLogSink*> installed_sink{nullptr};
+		LPTOP_LEVEL_EXCEPTION_FILTER previous_filter{nullptr};
+
+		bool IsFatal(const EXCEPTION_RECORD* record)
+		{
+			if (record->ExceptionFlags & EXCEPTION_NONCONTINUABLE)
+				return true;
+
+			switch (record->ExceptionCode)
+			{
+			case EXCEPTION_ACCESS_VIOLATION:
+			case EXCEPTION_IN_PAGE_ERROR:
+			case EXCEPTION_ILLEGAL_INSTRUCTION:
+			case EXCEPTION_PRIV_INSTRUCTION:
+			case EXCEPTION_INT_DIVIDE_BY_ZERO:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Only reached once no frame handler took the exception, the process is about to go down
+		LONG WINAPI DrainOnUnhandledException(PEXCEPTION_POINTERS exception_info)
+		{
+			if (IsFatal(exception_info->ExceptionRecord))
+			{
+				if (AsyncLogSink* sink = installed_sink.load())
+					sink->Drain();
+			}
+
+			return previous_filter ? previous_filter(exception_info) : EXCEPTION_CONTINUE_SEARCH;
+		}
+	} // namespace
+
+	AsyncLogSink::AsyncLogSink(std::vector<spdlog::sink_ptr> sinks, size_t queue_size, OverflowPolicy overflow_policy,
+		std::chrono::milliseconds flush_interval)
+		: sinks_(std::move(sinks)),
+		queue_size_((std::max)(queue_size, static_cast<size_t>(16))),
+		overflow_policy_(overflow_policy),
+		flush_interval_((std::max)(flush_interval, std::chrono::milliseconds(10)))
+	{
+		worker_ = std::thread(&AsyncLogSink::Run, this);
+	}
+
+	AsyncLogSink::~AsyncLogSink()
+	{
+		AsyncLogSink* self = this;
+		installed_sink.compare_exchange_strong(self, nullptr);
+
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex_);
+			stop_ = true;
+		}
+
+		not_empty_.notify_all();
+		not_full_.notify_all();
+
+		if (worker_.joinable())
+			worker_.join();
+
+		Drain();
+	}
+
+	AsyncLogSink::OverflowPolicy AsyncLogSink::ParseOverflowPolicy(const std::string& name)
+	{
+		if (name == "DiscardNew")
+			return OverflowPolicy::DiscardNew;
+		if (name == "DiscardOldest")
+			return OverflowPolicy::DiscardOldest;
+
+		return OverflowPolicy::Block;
+	}
+
+	void AsyncLogSink::InstallCrashHandler(const std::shared_ptr<AsyncLogSink>& sink)
+	{
+		// Chained in front of the previous top level filter, which still runs after the drain
+		if (installed_sink.exchange(sink.get()) == nullptr)
+			previous_filter = SetUnhandledExceptionFilter(&DrainOnUnhandledException);
+	}
+
+	void AsyncLogSink::DrainInstalled()
+	{
+		if (AsyncLogSink* sink = installed_sink.load())
+			sink->Drain();
+	}
+
+	void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+	{
+		Record record{
+			msg.logger_name ? *msg.logger_name : std::string(),
+			msg.level,
+			msg.time,
+			msg.thread_id,
+			std::string(msg.formatted.data(), msg.formatted.size())
+		};
+
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex_);
+
+			if (queue_.size() >= queue_size_)
+			{
+				// A wrapped sink logging from the writer thread must never wait for itself
+				const bool writer_thread = std::this_thread::get_id() == worker_.get_id();
+
+				if (overflow_policy_ == OverflowPolicy::DiscardNew || writer_thread || stop_)
+				{
+					++dropped_;
+					return;
+				}
+
+				if (overflow_policy_ == OverflowPolicy::DiscardOldest)
+				{
+					queue_.pop_front();
+					++dropped_;
+				}
+				else
+				{
+					not_full_.wait(lock, [this] { return queue_.size() < queue_size_ || stop_; });
+				}
+			}
+
+			// Warnings and errors reach the file right after the batch they are in, the rest waits for the interval
+			if (record.level >= spdlog::level::warn)
+				flush_requested_ = true;
+
+			queue_.push_back(std::move(record));
+		}
+
+		not_empty_.notify_one();
+	}
+
+	void AsyncLogSink::flush()
+	{
+		// Loggers flush on every info record, honouring that would flush the wrapped sinks after nearly every batch.
+		// Warnings request their own flush in log(), a crash or shutdown drains the queue.
+	}
+
+	void AsyncLogSink::Run()
+	{
+		std::deque<Record> batch;
+		auto last_flush = std::chrono::steady_clock::now();
+
+		for (;;)
+		{
+			bool flush_requested;
+			bool stop;
+			size_t dropped;
+
+			{
+				std::unique_lock<std::mutex> lock(queue_mutex_);
+				not_empty_.wait_for(lock, flush_interval_, [this] { return stop_ || flush_requested_ || !queue_.empty(); });
+
+				batch.swap(queue_);
+				flush_requested = std::exchange(flush_requested_, false);
+				dropped = std::exchange(dropped_, 0);
+				stop = stop_;
+			}
+
+			not_full_.notify_all();
+
+			{
+				std::lock_guard<std::timed_mutex> write_lock(write_mutex_);
+
+				if (dropped > 0)
+					WriteDropNotice(dropped);
+
+				const bool wrote = !batch.empty();
+				Write(batch);
+
+				const auto now = std::chrono::steady_clock::now();
+				if (flush_requested || (wrote && now - last_flush >= flush_interval_))
+				{
+					FlushSinks();
+					last_flush = now;
+				}
+			}
+
+			if (stop)
+				return;
+		}
+	}
+
+	void AsyncLogSink::Drain()
+	{
+		std::deque<Record> batch;
+		size_t dropped = 0;
+
+		// The crashing thread may have been inside log(), do not wait for it forever
+		std::unique_lock<std::mutex> queue_lock(queue_mutex_, std::defer_lock);
+		for (int attempt = 0; attempt < 50 && !queue_lock.try_lock(); ++attempt)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		if (!queue_lock.owns_lock())
+			return;
+
+		batch.swap(queue_);
+		dropped = std::exchange(dropped_, 0);
+		queue_lock.unlock();
+
+		not_full_.notify_all();
+
+		std::unique_lock<std::timed_mutex> write_lock(write_mutex_, std::defer_lock);
+		if (!write_lock.try_lock_for(std::chrono::milliseconds(500)))
+			return;
+
+		if (dropped > 0)
+			WriteDropNotice(dropped);
+
+		Write(batch);
+		FlushSinks();
+	}
+
+	void AsyncLogSink::Write(std::deque<Record>& batch)
+	{
+		for (const Record& record : batch)
+		{
+			spdlog::details::log_msg msg(&record.logger_name, record.level);
+			msg.time = record.time;
+			msg.thread_id = record.thread_id;
+			msg.formatted << record.text;
+
+			for (const auto& sink : sinks_)
+			{
+				if (!sink->should_log(record.level))
+					continue;
+
+				try
+				{
+					sink->log(msg);
+				}
+				catch (...)
+				{
+					// A failing sink must not take the writer thread down
+				}
+			}
+		}
+
+		batch.clear();
+	}
+
+	void AsyncLogSink::WriteDropNotice(size_t dropped)
+	{
+		static const std::string name = "API";
+
+		spdlog::details::log_msg msg(&name, spdlog::level::warn);
+		msg.raw << "Log queue overflowed, " << dropped << " messages were dropped";
+
+		spdlog::pattern_formatter("%D %R [%n][%l] %v").format(msg);
+
+		for (const auto& sink : sinks_)
+		{
+			try
+			{
+				sink->log(msg);
+			}
+			catch (...)
+			{
+			}
+		}
+	}
+
+	void AsyncLogSink::FlushSinks()
+	{
+		for (const auto& sink : sinks_)
+		{
+			try
+			{
+				sink->flush();
+			}
+			catch (...)
+			{
+			}
+		}
+	}
+} // namespace API
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Logger/Logger.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Sink that hands formatted records to a dedicated thread which writes them to the wrapped sinks.
+	 *
+	 * The calling thread only copies the formatted line into a bounded queue. The wrapped sinks are flushed every
+	 * `flush_interval` and right after a batch with a warning or above, `flush()` is ignored.
+	 */
+	class AsyncLogSink : public spdlog::sinks::sink
+	{
+	public:
+		enum class OverflowPolicy
+		{
+			Block,         // wait for the writer thread to make room
+			DiscardNew,    // drop the record being logged
+			DiscardOldest  // drop the oldest queued record
+		};
+
+		AsyncLogSink(std::vector<spdlog::sink_ptr> sinks, size_t queue_size, OverflowPolicy overflow_policy,
+			std::chrono::milliseconds flush_interval);
+		~AsyncLogSink() override;
+
+		AsyncLogSink(const AsyncLogSink&) = delete;
+		AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+		void log(const spdlog::details::log_msg& msg) override;
+		void flush() override;
+
+		/**
+		 * \brief Writes and flushes everything queued on the calling thread. Safe to call from a crash handler,
+		 * gives up if the writer thread does not release the wrapped sinks in time.
+		 */
+		void Drain();
+
+		static OverflowPolicy ParseOverflowPolicy(const std::string& name);
+
+		/**
+		 * \brief Drains `sink` when a fatal exception is left unhandled and takes the process down
+		 */
+		static void InstallCrashHandler(const std::shared_ptr<AsyncLogSink>& sink);
+
+		/**
+		 * \brief Drains the sink registered with `InstallCrashHandler`, if any. Used when the process shuts down.
+		 */
+		static void DrainInstalled();
+
+	private:
+		struct Record
+		{
+			std::string logger_name;
+			spdlog::level::level_enum level;
+			spdlog::log_clock::time_point time;
+			size_t thread_id;
+			std::string text;
+		};
+
+		void Run();
+		void Write(std::deque<Record>& batch);
+		void WriteDropNotice(size_t dropped);
+		void FlushSinks();
+
+		std::vector<spdlog::sink_ptr> sinks_;
+		const size_t queue_size_;
+		const OverflowPolicy overflow_policy_;
+		const std::chrono::milliseconds flush_interval_;
+
+		std::mutex queue_mutex_;
+		std::condition_variable not_empty_;
+		std::condition_variable not_full_;
+		std::deque<Record> queue_;
+		bool flush_requested_{false};
+		bool stop_{false};
+		size_t dropped_{0};
+
+		// Held while the wrapped sinks are written, timed so a crash drain cannot deadlock on it
+		std::timed_mutex write_mutex_;
+
+		std::thread worker_;
+	};
+} // namespace API
@@ -0,0 +1,287 @@
+#include "FlightRecorderSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+#include <Windows.h>
+
+namespace API
+{
+	namespace
+	{
+		constexpr char FileMagic[8] = {'A', 'S', 'A', 'F', 'R', 'E', 'C', '1'};
+		constexpr uint32_t FileVersion = 1;
+		constexpr uint32_t RecordMagic = 0x52464C41; // "ALFR"
+		constexpr uint64_t DataOffset = 64;
+		constexpr size_t MaxTextLength = 8192;
+
+#pragma pack(push, 1)
+		struct FileHeader
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t clean;
+			uint64_t capacity;
+			uint64_t write_position; // total bytes reserved since the start, 8 byte aligned
+			uint32_t process_id;
+			uint32_t reserved;
+			int64_t started_at;
+		};
+
+		struct RecordHeader
+		{
+			uint32_t magic;
+			uint32_t size; // including this header
+			int64_t time_ns;
+			uint32_t thread_id;
+			uint8_t level;
+			uint8_t name_length;
+			uint16_t reserved;
+		};
+#pragma pack(pop)
+
+		static_assert(sizeof(FileHeader) <= DataOffset);
+		static_assert(offsetof(FileHeader, write_position) % 8 == 0);
+
+		bool IsProcessRunning(uint32_t process_id)
+		{
+			const HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process_id);
+			if (process == nullptr)
+				return false;
+
+			DWORD exit_code = 0;
+			const bool running = GetExitCodeProcess(process, &exit_code) && exit_code == STILL_ACTIVE;
+			CloseHandle(process);
+
+			return running;
+		}
+	} // namespace
+
+	std::filesystem::path FlightRecorderSink::GetFileName(uint32_t process_id)
+	{
+		return "FlightRecorder_" + std::to_string(process_id) + ".bin";
+	}
+
+	FlightRecorderSink::FlightRecorderSink(const std::filesystem::path& path, uint64_t capacity)
+		: capacity_((std::max)(capacity, static_cast<uint64_t>(64 * 1024)))
+	{
+		const uint64_t file_size = DataOffset + capacity_;
+
+		file_ = CreateFileW(path.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_ == INVALID_HANDLE_VALUE)
+		{
+			file_ = nullptr;
+			return;
+		}
+
+		mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(file_size >> 32),
+			static_cast<DWORD>(file_size & 0xFFFFFFFF), nullptr);
+		if (mapping_ == nullptr)
+			return;
+
+		view_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(file_size)));
+		if (view_ == nullptr)
+			return;
+
+		auto* header = reinterpret_cast<FileHeader*>(view_);
+		std::memcpy(header->magic, FileMagic, sizeof(FileMagic));
+		header->version = FileVersion;
+		header->clean = 0;
+		header->capacity = capacity_;
+		header->write_position = 0;
+		header->process_id = GetCurrentProcessId();
+		header->started_at = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+
+		write_position_ = reinterpret_cast<std::atomic<uint64_t>*>(&header->write_position);
+		data_ = view_ + DataOffset;
+	}
+
+	FlightRecorderSink::~FlightRecorderSink()
+	{
+		if (view_ != nullptr)
+		{
+			reinterpret_cast<FileHeader*>(view_)->clean = 1;
+			FlushViewOfFile(view_, 0);
+			UnmapViewOfFile(view_);
+		}
+
+		if (mapping_ != nullptr)
+			CloseHandle(mapping_);
+
+		if (file_ != nullptr)
+			CloseHandle(file_);
+	}
+
+	void FlightRecorderSink::Copy(uint64_t position, const void* source, size_t length)
+	{
+		const uint64_t offset = position % capacity_;
+		const size_t first = static_cast<size_t>((std::min)(static_cast<uint64_t>(length), capacity_ - offset));
+
+		std::memcpy(data_ + offset, source, first);
+		if (length > first)
+			std::memcpy(data_, static_cast<const uint8_t*>(source) + first, length - first);
+	}
+
+	void FlightRecorderSink::log(const spdlog::details::log_msg& msg)
+	{
+		if (data_ == nullptr)
+			return;
+
+		const size_t name_length = msg.logger_name ? (std::min)(msg.logger_name->size(), static_cast<size_t>(255)) : 0;
+		const size_t text_length = (std::min)(msg.raw.size(), MaxTextLength);
+
+		// Records stay 8 byte aligned so a header never straddles the ring boundary in an odd way
+		const uint32_t size = static_cast<uint32_t>((sizeof(RecordHeader) + name_length + text_length + 7) & ~size_t(7));
+		const uint64_t position = write_position_->fetch_add(size, std::memory_order_relaxed);
+
+		const RecordHeader header{
+			RecordMagic,
+			size,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count(),
+			static_cast<uint32_t>(msg.thread_id),
+			static_cast<uint8_t>(msg.level),
+			static_cast<uint8_t>(name_length),
+			0
+		};
+
+		// Payload first, the header last, so a record torn by a crash fails validation when decoded
+		if (name_length > 0)
+			Copy(position + sizeof(RecordHeader), msg.logger_name->data(), name_length);
+		Copy(position + sizeof(RecordHeader) + name_length, msg.raw.data(), text_length);
+
+		std::atomic_thread_fence(std::memory_order_release);
+		Copy(position, &header, sizeof(header));
+	}
+
+	void FlightRecorderSink::flush()
+	{
+		// Dirty pages of the mapping are written by the system even if the process dies
+	}
+
+	bool FlightRecorderSink::Decode(const std::filesystem::path& path, std::ostream& out)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		FileHeader header{};
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0
+			|| header.version != FileVersion
+			|| header.capacity == 0)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> data(static_cast<size_t>(header.capacity));
+		file.seekg(DataOffset);
+		if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+			return false;
+
+		const uint64_t capacity = header.capacity;
+		const uint64_t end = header.write_position;
+
+		const auto read = [&](uint64_t position, void* destination, size_t length) {
+			const uint64_t offset = position % capacity;
+			const size_t first = static_cast<size_t>((std::min)(static_cast<uint64_t>(length), capacity - offset));
+
+			std::memcpy(destination, data.data() + offset, first);
+			if (length > first)
+				std::memcpy(static_cast<uint8_t*>(destination) + first, data.data(), length - first);
+		};
+
+		static const char* level_names[] = SPDLOG_LEVEL_NAMES;
+
+		out << "Flight recorder of process " << header.process_id << "\n";
+
+		// Everything older than one capacity has been overwritten, the first record after that is found by scanning
+		uint64_t position = end > capacity ? end - capacity : 0;
+		position = (position + 7) & ~uint64_t(7);
+
+		while (position + sizeof(RecordHeader) <= end)
+		{
+			RecordHeader record{};
+			read(position, &record, sizeof(record));
+
+			const bool valid = record.magic == RecordMagic
+				&& record.size >= sizeof(RecordHeader) + record.name_length
+				&& record.size <= sizeof(RecordHeader) + 255 + MaxTextLength + 8
+				&& record.size % 8 == 0
+				&& position + record.size <= end
+				&& record.level <= spdlog::level::off;
+
+			if (!valid)
+			{
+				position += 8;
+				continue;
+			}
+
+			std::string name(record.name_length, '\0');
+			read(position + sizeof(RecordHeader), name.data(), name.size());
+
+			std::string text(record.size - sizeof(RecordHeader) - record.name_length, '\0');
+			read(position + sizeof(RecordHeader) + record.name_length, text.data(), text.size());
+			text.erase(std::find(text.begin(), text.end(), '\0'), text.end());
+
+			const std::time_t seconds = static_cast<std::time_t>(record.time_ns / 1000000000);
+			std::tm time{};
+			localtime_s(&time, &seconds);
+
+			char time_text[32];
+			std::strftime(time_text, sizeof(time_text), "%m/%d/%y %H:%M:%S", &time);
+
+			out << time_text << " [" << name << "][" << level_names[record.level] << "][" << record.thread_id << "] " << text << "\n";
+
+			position += record.size;
+		}
+
+		return true;
+	}
+
+	std::vector<std::filesystem::path> FlightRecorderSink::RecoverCrashedSessions(const std::filesystem::path& directory)
+	{
+		namespace fs = std::filesystem;
+
+		std::vector<fs::path> recovered;
+		const std::string own_name = GetFileName(GetCurrentProcessId()).string();
+
+		std::error_code error;
+		for (const auto& entry : fs::directory_iterator(directory, error))
+		{
+			const std::string name = entry.path().filename().string();
+			if (name == own_name || name.rfind("FlightRecorder_", 0) != 0 || entry.path().extension() != ".bin")
+				continue;
+
+			FileHeader header{};
+			{
+				std::ifstream file(entry.path(), std::ios::binary);
+				if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+					continue;
+			}
+
+			// Another server sharing the logs directory
+			if (header.clean == 0 && IsProcessRunning(header.process_id))
+				continue;
+
+			if (header.clean == 0)
+			{
+				fs::path text_path = entry.path();
+				text_path.replace_extension(".crash.log");
+
+				std::ofstream out(text_path, std::ios::trunc);
+				if (out && Decode(entry.path(), out))
+					recovered.push_back(text_path);
+			}
+
+			fs::remove(entry.path(), error);
+		}
+
+		return recovered;
+	}
+} // namespace API
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Logger/Logger.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Sink that copies every record in binary form into a memory-mapped ring file.
+	 *
+	 * Pages of the mapping belong to the file, so the last `capacity` bytes of logging survive a crash of the
+	 * server without any flushing. A cleanly closed recorder marks its file, files of sessions that died are
+	 * decoded to text by `RecoverCrashedSessions` on the next start.
+	 */
+	class FlightRecorderSink : public spdlog::sinks::sink
+	{
+	public:
+		FlightRecorderSink(const std::filesystem::path& path, uint64_t capacity);
+		~FlightRecorderSink() override;
+
+		FlightRecorderSink(const FlightRecorderSink&) = delete;
+		FlightRecorderSink& operator=(const FlightRecorderSink&) = delete;
+
+		void log(const spdlog::details::log_msg& msg) override;
+		void flush() override;
+
+		bool IsOpen() const { return data_ != nullptr; }
+
+		/**
+		 * \brief Decodes a recorder file into text lines, oldest first
+		 * \return False if the file is not a recorder file
+		 */
+		static bool Decode(const std::filesystem::path& path, std::ostream& out);
+
+		/**
+		 * \brief Decodes recorder files in `directory` left behind by sessions that did not shut down cleanly
+		 * into `<name>.crash.log` and removes all recorder files of finished sessions
+		 * \return Paths of the written text files
+		 */
+		static std::vector<std::filesystem::path> RecoverCrashedSessions(const std::filesystem::path& directory);
+
+		static std::filesystem::path GetFileName(uint32_t process_id);
+
+	private:
+		void Copy(uint64_t position, const void* source, size_t length);
+
+		void* file_{nullptr};
+		void* mapping_{nullptr};
+		uint8_t* view_{nullptr};
+		uint8_t* data_{nullptr};
+		uint64_t capacity_{0};
+		std::atomic<uint64_t>* write_position_{nullptr};
+	};
+} // namespace API
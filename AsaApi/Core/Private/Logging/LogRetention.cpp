@@ -0,0 +1,195 @@
+#include "LogRetention.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <Logger/Logger.h>
+
+#include <Windows.h>
+
+#include "../Tools/Compression.h"
+
+namespace API
+{
+	namespace fs = std::filesystem;
+
+	namespace
+	{
+		struct LogFile
+		{
+			fs::path path;
+			uint64_t size;
+			fs::file_time_type time;
+		};
+
+		bool IsCompressible(const fs::path& path)
+		{
+			const fs::path extension = path.extension();
+			return extension == ".log" || extension == ".jsonl";
+		}
+	} // namespace
+
+	LogRetention& LogRetention::Get()
+	{
+		static LogRetention instance;
+		return instance;
+	}
+
+	LogRetention::~LogRetention()
+	{
+		Stop();
+	}
+
+	void LogRetention::Start(fs::path directory, const Settings& settings)
+	{
+		Stop();
+
+		directory_ = std::move(directory);
+		settings_ = settings;
+		own_process_id_ = std::to_string(GetCurrentProcessId());
+		stop_ = false;
+
+		worker_ = std::thread(&LogRetention::Run, this);
+	}
+
+	void LogRetention::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+
+		wake_.notify_all();
+
+		if (worker_.joinable())
+			worker_.join();
+	}
+
+	void LogRetention::Run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (wake_.wait_for(lock, settings_.initial_delay, [this] { return stop_; }))
+			return;
+
+		do
+		{
+			lock.unlock();
+
+			try
+			{
+				const PassResult result = RunPass();
+				if (result.compressed > 0 || result.deleted > 0)
+				{
+					Log::GetLog()->info("Log retention compressed {} and deleted {} files, freed {} MB", result.compressed,
+						result.deleted, result.freed_bytes / (1024 * 1024));
+				}
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			}
+
+			lock.lock();
+		}
+		while (!wake_.wait_for(lock, settings_.interval, [this] { return stop_; }));
+	}
+
+	bool LogRetention::IsOwnFile(const fs::path& path) const
+	{
+		// ArkApi_<pid>_<date>.log, FlightRecorder_<pid>.bin, Events_<pid>.jsonl
+		const std::string name = path.filename().string();
+
+		for (size_t position = name.find('_'); position != std::string::npos; position = name.find('_', position + 1))
+		{
+			if (name.compare(position + 1, own_process_id_.size(), own_process_id_) != 0)
+				continue;
+
+			const size_t end = position + 1 + own_process_id_.size();
+			if (end < name.size() && (name[end] == '_' || name[end] == '.'))
+				return true;
+		}
+
+		return false;
+	}
+
+	LogRetention::PassResult LogRetention::RunPass() const
+	{
+		PassResult result;
+		std::vector<LogFile> files;
+
+		std::error_code error;
+		for (const auto& entry : fs::directory_iterator(directory_, error))
+		{
+			std::error_code entry_error;
+			if (!entry.is_regular_file(entry_error) || IsOwnFile(entry.path()))
+				continue;
+
+			const uint64_t size = entry.file_size(entry_error);
+			const fs::file_time_type time = entry.last_write_time(entry_error);
+			if (!entry_error)
+				files.push_back({entry.path(), size, time});
+		}
+
+		const auto now = fs::file_time_type::clock::now();
+
+		if (settings_.compress)
+		{
+			for (LogFile& file : files)
+			{
+				if (!IsCompressible(file.path) || now - file.time < settings_.compress_after)
+					continue;
+
+				fs::path archive = file.path;
+				archive += ".gz";
+				if (fs::exists(archive, error))
+					continue;
+
+				std::string compress_error;
+				if (!Compression::GzipFile(file.path, archive, compress_error))
+					continue;
+
+				// Still held open by another server, its log is not finished yet
+				if (!fs::remove(file.path, error))
+				{
+					fs::remove(archive, error);
+					continue;
+				}
+
+				// Keep the age of the content, not of the archive
+				fs::last_write_time(archive, file.time, error);
+
+				const uint64_t archive_size = fs::file_size(archive, error);
+				result.freed_bytes += file.size > archive_size ? file.size - archive_size : 0;
+				++result.compressed;
+
+				file.path = std::move(archive);
+				file.size = archive_size;
+			}
+		}
+
+		std::sort(files.begin(), files.end(), [](const LogFile& a, const LogFile& b) { return a.time < b.time; });
+
+		uint64_t total_size = 0;
+		for (const LogFile& file : files)
+		{
+			total_size += file.size;
+		}
+
+		for (const LogFile& file : files)
+		{
+			const bool expired = now - file.time > settings_.max_age;
+			const bool over_size = settings_.max_total_size > 0 && total_size > settings_.max_total_size;
+			if (!expired && !over_size)
+				break;
+
+			if (!fs::remove(file.path, error))
+				continue;
+
+			total_size -= file.size;
+			result.freed_bytes += file.size;
+			++result.deleted;
+		}
+
+		return result;
+	}
+} // namespace API
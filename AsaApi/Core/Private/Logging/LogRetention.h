@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace API
+{
+	/**
+	 * \brief Keeps the logs directory bounded from a background thread.
+	 *
+	 * Idle text logs of other sessions are gzip compressed, files older than `max_age` are deleted and the oldest
+	 * files are deleted while the directory exceeds `max_total_size`. Files of the running process are never touched.
+	 */
+	class LogRetention
+	{
+	public:
+		struct Settings
+		{
+			std::chrono::hours max_age{24};
+			uint64_t max_total_size{0}; // 0 disables the size cap
+			bool compress{true};
+			std::chrono::minutes compress_after{60};
+			std::chrono::minutes interval{60};
+			std::chrono::seconds initial_delay{60};
+		};
+
+		static LogRetention& Get();
+
+		LogRetention(const LogRetention&) = delete;
+		LogRetention(LogRetention&&) = delete;
+		LogRetention& operator=(const LogRetention&) = delete;
+		LogRetention& operator=(LogRetention&&) = delete;
+
+		/**
+		 * \brief Starts the retention thread, the first pass runs after `initial_delay` so it stays off the boot path
+		 */
+		void Start(std::filesystem::path directory, const Settings& settings);
+		void Stop();
+
+	private:
+		struct PassResult
+		{
+			size_t compressed{0};
+			size_t deleted{0};
+			uint64_t freed_bytes{0};
+		};
+
+		LogRetention() = default;
+		~LogRetention();
+
+		void Run();
+		PassResult RunPass() const;
+		bool IsOwnFile(const std::filesystem::path& path) const;
+
+		std::filesystem::path directory_;
+		Settings settings_;
+		std::string own_process_id_;
+
+		std::mutex mutex_;
+		std::condition_variable wake_;
+		bool stop_{false};
+		std::thread worker_;
+	};
+} // namespace API
@@ -0,0 +1,296 @@
+#include "StructuredLogSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+#include <json.hpp>
+
+#include "../Tools/Compression.h"
+
+namespace API
+{
+	namespace
+	{
+		constexpr size_t MaxQueuedRecords = 65536;
+		constexpr size_t BatchSize = 512;
+		constexpr auto BatchInterval = std::chrono::milliseconds(250);
+
+		thread_local const std::string* event_message = nullptr;
+		thread_local const std::vector<LogField>* event_fields = nullptr;
+
+		std::string FormatTimestamp(spdlog::log_clock::time_point time)
+		{
+			const auto since_epoch = time.time_since_epoch();
+			const std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count();
+			const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch).count() % 1000;
+
+			std::tm utc{};
+			gmtime_s(&utc, &seconds);
+
+			char text[32];
+			const size_t length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+
+			return fmt::format("{}.{:03}Z", std::string(text, length), milliseconds);
+		}
+
+		std::string FormatFileTimestamp()
+		{
+			const std::time_t now = std::time(nullptr);
+
+			std::tm utc{};
+			gmtime_s(&utc, &now);
+
+			char text[32];
+			return std::string(text, std::strftime(text, sizeof(text), "%Y%m%d-%H%M%S", &utc));
+		}
+	} // namespace
+
+	StructuredLogSink::EventScope::EventScope(const std::string& message, const std::vector<LogField>& fields)
+	{
+		event_message = &message;
+		event_fields = &fields;
+	}
+
+	StructuredLogSink::EventScope::~EventScope()
+	{
+		event_message = nullptr;
+		event_fields = nullptr;
+	}
+
+	StructuredLogSink::StructuredLogSink(std::filesystem::path directory, std::string base_name, uint64_t max_file_size,
+		size_t max_files)
+		: directory_(std::move(directory)),
+		base_name_(std::move(base_name)),
+		max_file_size_((std::max)(max_file_size, static_cast<uint64_t>(1024 * 1024))),
+		max_files_(max_files)
+	{
+		OpenFile();
+
+		worker_ = std::thread(&StructuredLogSink::Run, this);
+	}
+
+	StructuredLogSink::~StructuredLogSink()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+
+		condition_.notify_all();
+
+		if (worker_.joinable())
+			worker_.join();
+
+		// The worker is gone without a final pass when the process is already exiting
+		std::vector<Record> batch;
+		batch.swap(queue_);
+		Write(batch, std::exchange(dropped_, 0));
+
+		if (compressor_.joinable())
+			compressor_.join();
+	}
+
+	void StructuredLogSink::log(const spdlog::details::log_msg& msg)
+	{
+		Record record{
+			msg.time,
+			msg.level,
+			msg.logger_name ? *msg.logger_name : std::string(),
+			msg.thread_id,
+			event_message ? *event_message : std::string(msg.raw.data(), msg.raw.size()),
+			event_fields ? *event_fields : std::vector<LogField>()
+		};
+
+		bool wake = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (queue_.size() >= MaxQueuedRecords)
+			{
+				++dropped_;
+				return;
+			}
+
+			// Warnings and errors are written out right away, everything else waits for a full batch or the interval
+			if (msg.level >= spdlog::level::warn)
+				flush_requested_ = true;
+
+			queue_.push_back(std::move(record));
+			wake = flush_requested_ || queue_.size() >= BatchSize;
+		}
+
+		if (wake)
+			condition_.notify_one();
+	}
+
+	void StructuredLogSink::flush()
+	{
+		// Loggers flush on every info record, honouring that would write one line per batch.
+		// Warnings request their own flush in log() and the destructor writes whatever is left.
+	}
+
+	void StructuredLogSink::Run()
+	{
+		std::vector<Record> batch;
+
+		for (;;)
+		{
+			size_t dropped;
+			bool stop;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait_for(lock, BatchInterval, [this]
+				{
+					return stop_ || flush_requested_ || queue_.size() >= BatchSize;
+				});
+
+				batch.swap(queue_);
+				dropped = std::exchange(dropped_, 0);
+				flush_requested_ = false;
+				stop = stop_;
+			}
+
+			Write(batch, dropped);
+
+			if (stop)
+				return;
+		}
+	}
+
+	void StructuredLogSink::Write(std::vector<Record>& batch, size_t dropped)
+	{
+		if (batch.empty() && dropped == 0)
+			return;
+
+		buffer_.clear();
+
+		const auto append = [this](const nlohmann::ordered_json& line)
+		{
+			buffer_ += line.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace);
+			buffer_ += '\n';
+		};
+
+		if (dropped > 0)
+		{
+			append({
+				{"ts", FormatTimestamp(spdlog::log_clock::now())},
+				{"level", "warning"},
+				{"logger", "API"},
+				{"msg", "Structured log queue overflowed"},
+				{"fields", {{"dropped", dropped}}}
+			});
+		}
+
+		for (const Record& record : batch)
+		{
+			nlohmann::ordered_json line{
+				{"ts", FormatTimestamp(record.time)},
+				{"level", spdlog::level::to_str(record.level)},
+				{"logger", record.logger_name},
+				{"thread", record.thread_id},
+				{"msg", record.message}
+			};
+
+			if (!record.fields.empty())
+			{
+				auto& fields = line["fields"] = nlohmann::ordered_json::object();
+				for (const LogField& field : record.fields)
+				{
+					std::visit([&](const auto& value) { fields[field.key] = value; }, field.value);
+				}
+			}
+
+			append(line);
+		}
+
+		batch.clear();
+
+		if (!file_.is_open())
+			return;
+
+		file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+		file_.flush();
+		file_size_ += buffer_.size();
+
+		if (file_size_ >= max_file_size_)
+			Rotate();
+	}
+
+	void StructuredLogSink::OpenFile()
+	{
+		const std::filesystem::path path = directory_ / (base_name_ + ".jsonl");
+
+		std::error_code error;
+		const auto size = std::filesystem::file_size(path, error);
+		file_size_ = error ? 0 : size;
+
+		file_.open(path, std::ios::binary | std::ios::app);
+	}
+
+	void StructuredLogSink::Rotate()
+	{
+		namespace fs = std::filesystem;
+
+		file_.close();
+
+		const std::string stem = base_name_ + "_" + FormatFileTimestamp();
+		fs::path rotated = directory_ / (stem + ".jsonl");
+		for (int index = 1; fs::exists(rotated) || fs::exists(fs::path(rotated).concat(".gz")); ++index)
+		{
+			rotated = directory_ / fmt::format("{}-{}.jsonl", stem, index);
+		}
+
+		std::error_code error;
+		fs::rename(directory_ / (base_name_ + ".jsonl"), rotated, error);
+
+		OpenFile();
+
+		if (error)
+			return;
+
+		// Only one archive is compressed at a time, rotations are far apart compared to compressing one file
+		if (compressor_.joinable())
+			compressor_.join();
+
+		compressor_ = std::thread([this, rotated]
+		{
+			std::string compress_error;
+			if (Compression::GzipFile(rotated, fs::path(rotated).concat(".gz"), compress_error))
+			{
+				std::error_code remove_error;
+				fs::remove(rotated, remove_error);
+			}
+
+			PruneArchives();
+		});
+	}
+
+	void StructuredLogSink::PruneArchives() const
+	{
+		namespace fs = std::filesystem;
+
+		std::vector<fs::path> archives;
+		const std::string prefix = base_name_ + "_";
+
+		std::error_code error;
+		for (const auto& entry : fs::directory_iterator(directory_, error))
+		{
+			const std::string name = entry.path().filename().string();
+			if (name.rfind(prefix, 0) == 0 && name.ends_with(".jsonl.gz"))
+				archives.push_back(entry.path());
+		}
+
+		if (archives.size() <= max_files_)
+			return;
+
+		// Timestamps in the names sort chronologically
+		std::sort(archives.begin(), archives.end());
+
+		for (size_t i = 0; i < archives.size() - max_files_; ++i)
+		{
+			fs::remove(archives[i], error);
+		}
+	}
+} // namespace API
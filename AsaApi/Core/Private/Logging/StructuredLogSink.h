@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Logger/Logger.h>
+#include <Logger/StructuredLog.h>
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Sink that writes one JSON object per line: ts, level, logger, thread, msg and the typed fields of
+	 * records logged with LogStructured.
+	 *
+	 * Records are serialized and written in batches by a worker thread. flush() is ignored, only warnings and above
+	 * cut a batch short. When the file exceeds `max_file_size` it is renamed and gzip compressed on a background
+	 * thread, only the newest `max_files` archives are kept.
+	 */
+	class StructuredLogSink : public spdlog::sinks::sink
+	{
+	public:
+		StructuredLogSink(std::filesystem::path directory, std::string base_name, uint64_t max_file_size,
+			size_t max_files);
+		~StructuredLogSink() override;
+
+		StructuredLogSink(const StructuredLogSink&) = delete;
+		StructuredLogSink& operator=(const StructuredLogSink&) = delete;
+
+		void log(const spdlog::details::log_msg& msg) override;
+		void flush() override;
+
+		/**
+		 * \brief Attaches message and fields to the records logged on this thread while the scope is alive
+		 */
+		class EventScope
+		{
+		public:
+			EventScope(const std::string& message, const std::vector<LogField>& fields);
+			~EventScope();
+
+			EventScope(const EventScope&) = delete;
+			EventScope& operator=(const EventScope&) = delete;
+		};
+
+	private:
+		struct Record
+		{
+			spdlog::log_clock::time_point time;
+			spdlog::level::level_enum level;
+			std::string logger_name;
+			size_t thread_id;
+			std::string message;
+			std::vector<LogField> fields;
+		};
+
+		void Run();
+		void Write(std::vector<Record>& batch, size_t dropped);
+		void OpenFile();
+		void Rotate();
+		void PruneArchives() const;
+
+		const std::filesystem::path directory_;
+		const std::string base_name_;
+		const uint64_t max_file_size_;
+		const size_t max_files_;
+
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::vector<Record> queue_;
+		bool flush_requested_{false};
+		bool stop_{false};
+		size_t dropped_{0};
+
+		std::ofstream file_;
+		uint64_t file_size_{0};
+		std::string buffer_;
+
+		std::thread worker_;
+		std::thread compressor_;
+	};
+} // namespace API
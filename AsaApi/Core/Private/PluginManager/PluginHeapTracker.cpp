@@ -0,0 +1,311 @@
+#include "PluginHeapTracker.h"
+
+#include <algorithm>
+#include <intrin.h>
+
+#include <Logger/Logger.h>
+
+#include "../Hooks.h"
+#include "../IBaseApi.h"
+
+#include <Psapi.h>
+
+namespace API
+{
+	namespace
+	{
+		using MallocFn = void*(__cdecl*)(size_t);
+		using CallocFn = void*(__cdecl*)(size_t, size_t);
+		using ReallocFn = void*(__cdecl*)(void*, size_t);
+		using FreeFn = void(__cdecl*)(void*);
+
+		MallocFn original_malloc = nullptr;
+		CallocFn original_calloc = nullptr;
+		ReallocFn original_realloc = nullptr;
+		FreeFn original_free = nullptr;
+
+		// Set while the tracker itself runs, its own allocations go straight to the CRT
+		thread_local bool in_tracker = false;
+
+		class TrackerScope
+		{
+		public:
+			TrackerScope() : previous_(in_tracker) { in_tracker = true; }
+			~TrackerScope() { in_tracker = previous_; }
+
+			TrackerScope(const TrackerScope&) = delete;
+			TrackerScope& operator=(const TrackerScope&) = delete;
+
+		private:
+			bool previous_;
+		};
+
+		void* __cdecl MallocDetour(size_t size)
+		{
+			void* block = original_malloc(size);
+			if (block != nullptr && !in_tracker)
+			{
+				TrackerScope scope;
+				PluginHeapTracker::Get().Track(block, size, _ReturnAddress());
+			}
+
+			return block;
+		}
+
+		void* __cdecl CallocDetour(size_t count, size_t size)
+		{
+			void* block = original_calloc(count, size);
+			if (block != nullptr && !in_tracker)
+			{
+				TrackerScope scope;
+				PluginHeapTracker::Get().Track(block, count * size, _ReturnAddress());
+			}
+
+			return block;
+		}
+
+		void* __cdecl ReallocDetour(void* block, size_t size)
+		{
+			if (in_tracker)
+				return original_realloc(block, size);
+
+			TrackerScope scope;
+			auto& tracker = PluginHeapTracker::Get();
+
+			PluginHeapTracker::Block removed{};
+			const bool tracked = block != nullptr && tracker.Untrack(block, removed);
+
+			void* result = original_realloc(block, size);
+			if (result != nullptr)
+				tracker.Track(result, size, _ReturnAddress());
+			else if (tracked && size != 0)
+				tracker.Restore(block, removed); // Failed, the old block is still there
+
+			return result;
+		}
+
+		void __cdecl FreeDetour(void* block)
+		{
+			if (block != nullptr && !in_tracker)
+			{
+				TrackerScope scope;
+				PluginHeapTracker::Block removed{};
+				PluginHeapTracker::Get().Untrack(block, removed);
+			}
+
+			original_free(block);
+		}
+	} // namespace
+
+	PluginHeapTracker& PluginHeapTracker::Get()
+	{
+		// Never destroyed, the detours stay installed until the process is gone
+		static PluginHeapTracker* instance = new PluginHeapTracker;
+		return *instance;
+	}
+
+	size_t PluginHeapTracker::ShardOf(const void* block)
+	{
+		return static_cast<size_t>(((reinterpret_cast<uintptr_t>(block) >> 4) * 0x9E3779B97F4A7C15ull) >> 58) % ShardCount;
+	}
+
+	bool PluginHeapTracker::Enable()
+	{
+		if (enabled_)
+			return true;
+
+		const HMODULE ucrt = GetModuleHandleW(L"ucrtbase.dll");
+		if (ucrt == nullptr)
+		{
+			Log::GetLog()->warn("({}) ucrtbase.dll is not loaded, plugin heaps are not tracked", __FUNCTION__);
+			return false;
+		}
+
+		original_malloc = reinterpret_cast<MallocFn>(GetProcAddress(ucrt, "malloc"));
+		original_calloc = reinterpret_cast<CallocFn>(GetProcAddress(ucrt, "calloc"));
+		original_realloc = reinterpret_cast<ReallocFn>(GetProcAddress(ucrt, "realloc"));
+		original_free = reinterpret_cast<FreeFn>(GetProcAddress(ucrt, "free"));
+
+		if (!original_malloc || !original_calloc || !original_realloc || !original_free)
+		{
+			Log::GetLog()->warn("({}) CRT heap functions not found, plugin heaps are not tracked", __FUNCTION__);
+			return false;
+		}
+
+		enabled_ = dynamic_cast<Hooks&>(*game_api->GetHooks()).AttachDetours({
+			{reinterpret_cast<LPVOID*>(&original_malloc), reinterpret_cast<LPVOID>(&MallocDetour)},
+			{reinterpret_cast<LPVOID*>(&original_calloc), reinterpret_cast<LPVOID>(&CallocDetour)},
+			{reinterpret_cast<LPVOID*>(&original_realloc), reinterpret_cast<LPVOID>(&ReallocDetour)},
+			{reinterpret_cast<LPVOID*>(&original_free), reinterpret_cast<LPVOID>(&FreeDetour)}
+		});
+
+		if (enabled_)
+			Log::GetLog()->info("Tracking CRT heap usage of plugins");
+
+		return enabled_;
+	}
+
+	void PluginHeapTracker::AddModule(HMODULE module)
+	{
+		if (!enabled_ || module == nullptr)
+			return;
+
+		TrackerScope scope;
+
+		MODULEINFO info{};
+		if (!GetModuleInformation(GetCurrentProcess(), module, &info, sizeof(info)))
+			return;
+
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(info.lpBaseOfDll);
+
+		std::unique_lock<std::shared_mutex> lock(ranges_mutex_);
+
+		const auto free_slot = std::find_if(counters_.begin(), counters_.end(),
+			[](const Counters& counters) { return counters.module == nullptr; });
+		if (free_slot == counters_.end())
+		{
+			lock.unlock();
+			Log::GetLog()->warn("({}) All {} heap tracking slots are in use", __FUNCTION__, MaxModules);
+			return;
+		}
+
+		free_slot->module = module;
+		free_slot->live_bytes = 0;
+		free_slot->live_blocks = 0;
+		free_slot->allocated_bytes = 0;
+
+		const Range range{begin, begin + info.SizeOfImage, static_cast<uint16_t>(free_slot - counters_.begin())};
+		ranges_.insert(std::upper_bound(ranges_.begin(), ranges_.end(), range,
+			[](const Range& a, const Range& b) { return a.begin < b.begin; }), range);
+	}
+
+	void PluginHeapTracker::RemoveModule(HMODULE module)
+	{
+		if (!enabled_ || module == nullptr)
+			return;
+
+		TrackerScope scope;
+		std::unique_lock<std::shared_mutex> lock(ranges_mutex_);
+
+		for (auto iter = ranges_.begin(); iter != ranges_.end(); ++iter)
+		{
+			Counters& counters = counters_[iter->slot];
+			if (counters.module != module)
+				continue;
+
+			// Blocks of the module that are still alive no longer count against the slot once it is reused
+			counters.module = nullptr;
+			++counters.generation;
+
+			ranges_.erase(iter);
+			return;
+		}
+	}
+
+	bool PluginHeapTracker::FindSlot(const void* caller, uint16_t& slot) const
+	{
+		const uintptr_t address = reinterpret_cast<uintptr_t>(caller);
+
+		// GetModuleHandleEx takes the loader lock, the ranges of the loaded plugins are searched instead
+		std::shared_lock<std::shared_mutex> lock(ranges_mutex_);
+
+		auto iter = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+			[](uintptr_t value, const Range& range) { return value < range.begin; });
+		if (iter == ranges_.begin())
+			return false;
+
+		--iter;
+		if (address >= iter->end)
+			return false;
+
+		slot = iter->slot;
+		return true;
+	}
+
+	void PluginHeapTracker::Track(void* block, size_t size, const void* caller)
+	{
+		uint16_t slot;
+		if (!FindSlot(caller, slot))
+			return;
+
+		Counters& counters = counters_[slot];
+		const Block entry{size, slot, counters.generation.load(std::memory_order_relaxed)};
+
+		{
+			Shard& shard = shards_[ShardOf(block)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.blocks.insert_or_assign(block, entry);
+		}
+
+		counters.live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+		counters.live_blocks.fetch_add(1, std::memory_order_relaxed);
+		counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		tracked_blocks_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool PluginHeapTracker::Untrack(void* block, Block& removed)
+	{
+		if (tracked_blocks_.load(std::memory_order_relaxed) <= 0)
+			return false;
+
+		{
+			Shard& shard = shards_[ShardOf(block)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			const auto iter = shard.blocks.find(block);
+			if (iter == shard.blocks.end())
+				return false;
+
+			removed = iter->second;
+			shard.blocks.erase(iter);
+		}
+
+		tracked_blocks_.fetch_sub(1, std::memory_order_relaxed);
+
+		Counters& counters = counters_[removed.slot];
+		if (counters.generation.load(std::memory_order_relaxed) == removed.generation)
+		{
+			counters.live_bytes.fetch_sub(static_cast<int64_t>(removed.size), std::memory_order_relaxed);
+			counters.live_blocks.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		return true;
+	}
+
+	void PluginHeapTracker::Restore(void* block, const Block& removed)
+	{
+		{
+			Shard& shard = shards_[ShardOf(block)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.blocks.insert_or_assign(block, removed);
+		}
+
+		tracked_blocks_.fetch_add(1, std::memory_order_relaxed);
+
+		Counters& counters = counters_[removed.slot];
+		if (counters.generation.load(std::memory_order_relaxed) == removed.generation)
+		{
+			counters.live_bytes.fetch_add(static_cast<int64_t>(removed.size), std::memory_order_relaxed);
+			counters.live_blocks.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	std::vector<PluginHeapTracker::Usage> PluginHeapTracker::GetUsage() const
+	{
+		std::vector<Usage> usage;
+		if (!enabled_)
+			return usage;
+
+		TrackerScope scope;
+		std::shared_lock<std::shared_mutex> lock(ranges_mutex_);
+
+		for (const Range& range : ranges_)
+		{
+			const Counters& counters = counters_[range.slot];
+			usage.push_back({counters.module, counters.live_bytes.load(std::memory_order_relaxed),
+				counters.live_blocks.load(std::memory_order_relaxed), counters.allocated_bytes.load(std::memory_order_relaxed)});
+		}
+
+		return usage;
+	}
+} // namespace API
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <Windows.h>
+
+namespace API
+{
+	/**
+	 * \brief Live CRT heap usage per plugin module, attributed by the return address of the allocation.
+	 *
+	 * malloc, calloc, realloc and free of ucrtbase are detoured. Plugins built with /MD share that heap, their
+	 * operator new is linked into the plugin and calls malloc, so the caller of malloc lies inside the plugin image.
+	 * A block is charged to the module that allocated it no matter which module frees it. Memory the plugin gets
+	 * from the game allocator (FMemory) is not seen. Opt-in through the `TrackPluginHeap` setting because every
+	 * CRT allocation of the process pays for the lookup once it is enabled.
+	 */
+	class PluginHeapTracker
+	{
+	public:
+		struct Usage
+		{
+			HMODULE module;
+			int64_t live_bytes;
+			int64_t live_blocks;
+			uint64_t allocated_bytes;
+		};
+
+		struct Block
+		{
+			size_t size;
+			uint16_t slot;
+			uint16_t generation;
+		};
+
+		static PluginHeapTracker& Get();
+
+		PluginHeapTracker(const PluginHeapTracker&) = delete;
+		PluginHeapTracker(PluginHeapTracker&&) = delete;
+		PluginHeapTracker& operator=(const PluginHeapTracker&) = delete;
+		PluginHeapTracker& operator=(PluginHeapTracker&&) = delete;
+
+		/**
+		 * \brief Installs the CRT detours, call it before plugins are loaded
+		 */
+		bool Enable();
+
+		bool IsEnabled() const { return enabled_; }
+
+		/**
+		 * \brief Starts charging allocations made from the image of a plugin
+		 */
+		void AddModule(HMODULE module);
+
+		/**
+		 * \brief Stops charging a module that is about to be unloaded, its handle may be reused by the next load
+		 */
+		void RemoveModule(HMODULE module);
+
+		std::vector<Usage> GetUsage() const;
+
+		// Called by the detours. Blocks are untracked before they are freed, so a new block at the same address
+		// is never dropped by a late free.
+		void Track(void* block, size_t size, const void* caller);
+		bool Untrack(void* block, Block& removed);
+		void Restore(void* block, const Block& removed);
+
+	private:
+		static constexpr size_t MaxModules = 256;
+		static constexpr size_t ShardCount = 64;
+
+		struct Range
+		{
+			uintptr_t begin;
+			uintptr_t end;
+			uint16_t slot;
+		};
+
+		struct Counters
+		{
+			HMODULE module{nullptr};
+			std::atomic<uint16_t> generation{0};
+			std::atomic<int64_t> live_bytes{0};
+			std::atomic<int64_t> live_blocks{0};
+			std::atomic<uint64_t> allocated_bytes{0};
+		};
+
+		struct Shard
+		{
+			std::mutex mutex;
+			std::unordered_map<void*, Block> blocks;
+		};
+
+		PluginHeapTracker() = default;
+		~PluginHeapTracker() = default;
+
+		static size_t ShardOf(const void* block);
+
+		bool FindSlot(const void* caller, uint16_t& slot) const;
+
+		bool enabled_{false};
+
+		// Sorted by begin, replaced under the exclusive lock when a plugin is loaded or unloaded
+		std::vector<Range> ranges_;
+		mutable std::shared_mutex ranges_mutex_;
+
+		std::array<Counters, MaxModules> counters_{};
+		std::array<Shard, ShardCount> shards_{};
+
+		// Frees only look for their block while any tracked block is alive
+		std::atomic<int64_t> tracked_blocks_{0};
+	};
+} // namespace API
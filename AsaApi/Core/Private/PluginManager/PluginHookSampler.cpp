@@ -0,0 +1,229 @@
+#include "PluginHookSampler.h"
+#include "PluginProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <Logger/Logger.h>
+
+#include "../Hooks.h"
+#include "../IBaseApi.h"
+
+#include <Psapi.h>
+
+namespace API
+{
+	namespace
+	{
+		constexpr int MaxFrames = 64;
+		constexpr auto RefreshInterval = std::chrono::seconds(1);
+
+		thread_local bool sampled_thread = false;
+		std::atomic<bool> callback_active{false};
+	} // namespace
+
+	PluginHookSampler& PluginHookSampler::Get()
+	{
+		// Never destroyed, the sampling thread runs until the process is gone
+		static PluginHookSampler* instance = new PluginHookSampler;
+		return *instance;
+	}
+
+	void PluginHookSampler::SetCallbackActive(bool active)
+	{
+		if (sampled_thread)
+			callback_active.store(active, std::memory_order_relaxed);
+	}
+
+	void PluginHookSampler::Start(unsigned samples_per_second)
+	{
+		if (running_ || samples_per_second == 0)
+			return;
+
+		if (!DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &thread_,
+			THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE, 0))
+		{
+			Log::GetLog()->warn("({}) Cannot open the game thread ({}), plugin hooks are not sampled", __FUNCTION__,
+				GetLastError());
+			return;
+		}
+
+		sampled_thread = true;
+		running_ = true;
+
+		Refresh();
+
+		samples_per_second = (std::min)(samples_per_second, 1000u);
+		std::thread(&PluginHookSampler::Run, this, samples_per_second).detach();
+
+		Log::GetLog()->info("Sampling plugin hooks {} times per second", samples_per_second);
+	}
+
+	void PluginHookSampler::AddModule(HMODULE module)
+	{
+		if (!running_ || module == nullptr)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			plugins_.insert(module);
+		}
+
+		Refresh();
+	}
+
+	void PluginHookSampler::RemoveModule(HMODULE module)
+	{
+		if (!running_)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			plugins_.erase(module);
+		}
+
+		Refresh();
+	}
+
+	void PluginHookSampler::Refresh()
+	{
+		std::unordered_set<uintptr_t> hook_targets;
+		for (const LPVOID target : dynamic_cast<Hooks&>(*game_api->GetHooks()).GetHookTargets())
+			hook_targets.insert(reinterpret_cast<uintptr_t>(target));
+
+		std::vector<HMODULE> modules(512);
+		DWORD needed = 0;
+		while (EnumProcessModules(GetCurrentProcess(), modules.data(), static_cast<DWORD>(modules.size() * sizeof(HMODULE)),
+			&needed) && needed > modules.size() * sizeof(HMODULE))
+		{
+			modules.resize(needed / sizeof(HMODULE));
+		}
+		modules.resize((std::min)(modules.size(), static_cast<size_t>(needed / sizeof(HMODULE))));
+
+		std::vector<Image> images;
+		images.reserve(modules.size());
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (const HMODULE module : modules)
+		{
+			MODULEINFO info{};
+			if (!GetModuleInformation(GetCurrentProcess(), module, &info, sizeof(info)))
+				continue;
+
+			const uintptr_t begin = reinterpret_cast<uintptr_t>(info.lpBaseOfDll);
+			images.push_back(Image{begin, begin + info.SizeOfImage, module,
+				plugins_.contains(module) ? ImageKind::Plugin : ImageKind::Other});
+		}
+
+		std::sort(images.begin(), images.end(), [](const Image& a, const Image& b) { return a.begin < b.begin; });
+
+		images_.swap(images);
+		hook_targets_.swap(hook_targets);
+	}
+
+	void PluginHookSampler::Run(unsigned samples_per_second)
+	{
+		HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if (timer == nullptr)
+			timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+
+		const LONG period_ms = static_cast<LONG>((std::max)(1000u / samples_per_second, 1u));
+		LARGE_INTEGER due{};
+		due.QuadPart = -static_cast<LONGLONG>(period_ms) * 10000;
+		SetWaitableTimer(timer, &due, period_ms, nullptr, nullptr, FALSE);
+
+		auto last_sample = std::chrono::steady_clock::now();
+		auto last_refresh = last_sample;
+
+		for (;;)
+		{
+			WaitForSingleObject(timer, INFINITE);
+
+			const auto now = std::chrono::steady_clock::now();
+			if (now - last_refresh >= RefreshInterval)
+			{
+				Refresh();
+				last_refresh = now;
+			}
+
+			const HMODULE owner = Sample();
+
+			// Each sample stands for the time since the previous one
+			if (owner != nullptr)
+			{
+				PluginProfiler::Get().Record(owner, PluginProfiler::Category::Hook,
+					std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_sample));
+			}
+
+			last_sample = now;
+		}
+	}
+
+	HMODULE PluginHookSampler::Sample()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		// Nothing below may allocate or log, the suspended thread could hold the heap or logger lock
+		if (SuspendThread(thread_) == static_cast<DWORD>(-1))
+			return nullptr;
+
+		HMODULE owner = nullptr;
+
+		CONTEXT context{};
+		context.ContextFlags = CONTEXT_CONTROL | CONTEXT_INTEGER;
+		if (!callback_active.load(std::memory_order_relaxed) && GetThreadContext(thread_, &context))
+			owner = Walk(context);
+
+		ResumeThread(thread_);
+
+		return owner;
+	}
+
+	HMODULE PluginHookSampler::Walk(CONTEXT& context) const
+	{
+		for (int frame = 0; frame < MaxFrames && context.Rip != 0; ++frame)
+		{
+			const Image* image = FindImage(context.Rip);
+			if (image == nullptr)
+				return nullptr;
+
+			if (image->kind == ImageKind::Plugin)
+				return image->module;
+
+			DWORD64 image_base = 0;
+			const PRUNTIME_FUNCTION function = RtlLookupFunctionEntry(context.Rip, &image_base, nullptr);
+
+			if (function == nullptr)
+			{
+				// Leaf function, the return address is on top of the stack
+				context.Rip = *reinterpret_cast<const DWORD64*>(context.Rsp);
+				context.Rsp += sizeof(DWORD64);
+				continue;
+			}
+
+			// An original called by a detour, the game's own time
+			if (hook_targets_.contains(static_cast<uintptr_t>(image_base + function->BeginAddress)))
+				return nullptr;
+
+			PVOID handler_data = nullptr;
+			DWORD64 establisher_frame = 0;
+			RtlVirtualUnwind(UNW_FLAG_NHANDLER, image_base, context.Rip, function, &context, &handler_data,
+				&establisher_frame, nullptr);
+		}
+
+		return nullptr;
+	}
+
+	const PluginHookSampler::Image* PluginHookSampler::FindImage(uintptr_t address) const
+	{
+		auto iter = std::upper_bound(images_.begin(), images_.end(), address,
+			[](uintptr_t value, const Image& image) { return value < image.begin; });
+		if (iter == images_.begin())
+			return nullptr;
+
+		--iter;
+		return address < iter->end ? &*iter : nullptr;
+	}
+} // namespace API
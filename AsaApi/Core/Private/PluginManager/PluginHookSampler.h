@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <Windows.h>
+
+namespace API
+{
+	/**
+	 * \brief Charges game thread time spent in plugin hook detours to the plugin, by sampling the game thread.
+	 *
+	 * A background thread suspends the game thread at a fixed rate and unwinds its stack. The sample goes to the
+	 * innermost plugin frame, unless a hooked game function (an original called by a detour) is running below it,
+	 * so a detour is not charged for the game code it wraps. Samples taken while a profiled callback runs are
+	 * skipped, PluginProfiler::Scope already measures those exactly.
+	 *
+	 * Only image code is unwound. A frame in dynamically generated code ends the walk, looking up its unwind data
+	 * could wait on a lock the suspended thread holds.
+	 */
+	class PluginHookSampler
+	{
+	public:
+		static PluginHookSampler& Get();
+
+		PluginHookSampler(const PluginHookSampler&) = delete;
+		PluginHookSampler(PluginHookSampler&&) = delete;
+		PluginHookSampler& operator=(const PluginHookSampler&) = delete;
+		PluginHookSampler& operator=(PluginHookSampler&&) = delete;
+
+		/**
+		 * \brief Starts sampling the calling thread, which has to be the game thread
+		 * \param samples_per_second 1 to 1000
+		 */
+		void Start(unsigned samples_per_second);
+
+		bool IsRunning() const { return running_; }
+
+		/**
+		 * \brief Samples are only charged to plugin modules
+		 */
+		void AddModule(HMODULE module);
+		void RemoveModule(HMODULE module);
+
+		/**
+		 * \brief Called by the outermost PluginProfiler::Scope of a thread
+		 */
+		static void SetCallbackActive(bool active);
+
+	private:
+		enum class ImageKind : uint8_t
+		{
+			Other,
+			Plugin
+		};
+
+		struct Image
+		{
+			uintptr_t begin;
+			uintptr_t end;
+			HMODULE module;
+			ImageKind kind;
+		};
+
+		PluginHookSampler() = default;
+		~PluginHookSampler() = default;
+
+		void Run(unsigned samples_per_second);
+
+		// Re-reads the loaded images and the hooked functions, never while the game thread is suspended
+		void Refresh();
+
+		HMODULE Sample();
+		HMODULE Walk(CONTEXT& context) const;
+		const Image* FindImage(uintptr_t address) const;
+
+		std::atomic<bool> running_{false};
+		HANDLE thread_{nullptr};
+
+		// Held across every sample, whoever changes the tables cannot be the suspended thread
+		std::mutex mutex_;
+		std::vector<Image> images_; // sorted by begin
+		std::unordered_set<HMODULE> plugins_;
+		std::unordered_set<uintptr_t> hook_targets_;
+	};
+} // namespace API
@@ -1,8 +1,14 @@
 #include "PluginManager.h"
+#include "PluginProfiler.h"
+#include "PluginHeapTracker.h"
+#include "PluginHookSampler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 #include <Logger/Logger.h>
 #include "Tools.h"
@@ -11,7 +17,10 @@
 #include "../Hooks.h"
 #include <Timer.h>
 #include "../Ark/ApiUtils.h"
+#include "../Ark/ActorRegistry.h"
 #include "Requests.h"
+#include "WebSockets.h"
+#include "ConfigService.h"
 
 namespace API
 {
@@ -21,29 +30,25 @@ namespace API
 		return instance;
 	}
 
-	nlohmann::json PluginManager::ReadSettingsConfig()
+	void PluginManager::LoadAllPlugins()
 	{
-		nlohmann::json config = nlohmann::json::object({});
-
-		const std::string config_path = Tools::GetCurrentDir() + "/config.json";
-		std::ifstream file{ config_path };
-		if (!file.is_open())
-		{
-			return config;
-		}
+		namespace fs = std::filesystem;
 
-		file >> config;
-		file.close();
+		const auto start = std::chrono::steady_clock::now();
 
-		return config;
-	}
+		// Before the first plugin is loaded, blocks allocated earlier could not be attributed anyway
+		{
+			const auto config = ConfigService::Get().GetConfig();
+			if (ConfigService::GetSettings(config).value("TrackPluginHeap", false))
+				PluginHeapTracker::Get().Enable();
 
-	void PluginManager::LoadAllPlugins()
-	{
-		namespace fs = std::filesystem;
+			// Called from UEngine::Init, the sampled thread is the game thread
+			PluginHookSampler::Get().Start(ConfigService::GetSettings(config).value("PluginHookSamplingHz", 0u));
+		}
 
 		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins";
 
+		std::vector<std::string> plugin_names;
 		for (const auto& dir_name : fs::directory_iterator(dir_path))
 		{
 			const auto& path = dir_name.path();
@@ -52,30 +57,36 @@ namespace API
 				continue;
 			}
 
-			const auto filename = path.filename().stem().generic_string();
+			plugin_names.push_back(path.filename().stem().generic_string());
+		}
+
+		// File work of all plugins runs concurrently, LoadLibrary and Plugin_Init stay on this thread
+		const std::vector<StagedPlugin> staged = StagePlugins(plugin_names);
 
-			const std::string dir_file_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" +
-				filename;
-			const std::string full_dll_path = dir_file_path + "/" + filename + ".dll";
-			const std::string new_full_dll_path = dir_file_path + "/" + filename + ".dll.ArkApi";
+		for (const size_t index : SortByDependencies(staged))
+		{
+			const StagedPlugin& staged_plugin = staged[index];
+			if (!staged_plugin.error.empty())
+			{
+				Log::GetLog()->warn("({}) {}", __FUNCTION__, staged_plugin.error);
+				continue;
+			}
 
 			try
 			{
-				// Loads the new .dll.ArkApi if it exists on startup as well
-				if (fs::exists(new_full_dll_path))
-				{
-					copy_file(new_full_dll_path, full_dll_path, fs::copy_options::overwrite_existing);
-					fs::remove(new_full_dll_path);
-				}
+				const auto load_start = std::chrono::steady_clock::now();
 
-				std::stringstream stream;
+				std::shared_ptr<Plugin>& plugin = LoadPlugin(staged_plugin.name, staged_plugin.info);
 
-				std::shared_ptr<Plugin>& plugin = LoadPlugin(filename);
+				const std::chrono::duration<double, std::milli> load_time = std::chrono::steady_clock::now() - load_start;
+				const std::chrono::duration<double, std::milli> stage_time = staged_plugin.stage_time;
+
+				std::stringstream stream;
 
 				stream << "Loaded plugin " << (plugin->full_name.empty() ? plugin->name : plugin->full_name) << " V" <<
 					plugin->version << " (" << plugin->description << ")";
 
-				Log::GetLog()->info(stream.str());
+				Log::GetLog()->info("{} in {:.1f} ms (staged in {:.1f} ms)", stream.str(), load_time.count(), stage_time.count());
 			}
 			catch (const std::exception& error)
 			{
@@ -86,19 +97,158 @@ namespace API
 		CheckPluginsDependencies();
 
 		// Set auto plugins reloading
-		auto settings = ReadSettingsConfig();
+		const auto config = ConfigService::Get().GetConfig();
+		const nlohmann::json& settings = ConfigService::GetSettings(config);
 
-		enable_plugin_reload_ = settings["settings"].value("AutomaticPluginReloading", false);
+		enable_plugin_reload_ = settings.value("AutomaticPluginReloading", false);
 		if (enable_plugin_reload_)
 		{
-			reload_sleep_seconds_ = settings["settings"].value("AutomaticPluginReloadSeconds", 5);
-			save_world_before_reload_ = settings["settings"].value("SaveWorldBeforePluginReload", true);
+			reload_sleep_seconds_ = settings.value("AutomaticPluginReloadSeconds", 5);
+			save_world_before_reload_ = settings.value("SaveWorldBeforePluginReload", true);
+
+			StartPluginWatcher();
+		}
+
+		idle_init_budget_ = std::chrono::microseconds(
+			static_cast<int64_t>(settings.value("PluginIdleInitBudgetMs", 2.0) * 1000));
+
+		const std::chrono::duration<double, std::milli> total_time = std::chrono::steady_clock::now() - start;
+		Log::GetLog()->info("Loaded all plugins in {:.1f} ms\n", total_time.count());
+	}
+
+	std::vector<PluginManager::StagedPlugin> PluginManager::StagePlugins(const std::vector<std::string>& plugin_names)
+	{
+		namespace fs = std::filesystem;
+
+		std::vector<StagedPlugin> staged(plugin_names.size());
+		std::atomic<size_t> next_index{0};
+
+		const auto stage = [&]()
+		{
+			for (size_t index = next_index++; index < staged.size(); index = next_index++)
+			{
+				StagedPlugin& plugin = staged[index];
+				plugin.name = plugin_names[index];
+
+				const auto start = std::chrono::steady_clock::now();
+
+				const std::string dir_file_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" +
+					plugin.name;
+				const std::string full_dll_path = dir_file_path + "/" + plugin.name + ".dll";
+				const std::string new_full_dll_path = dir_file_path + "/" + plugin.name + ".dll.ArkApi";
+
+				try
+				{
+					// Loads the new .dll.ArkApi if it exists on startup as well
+					if (fs::exists(new_full_dll_path))
+					{
+						copy_file(new_full_dll_path, full_dll_path, fs::copy_options::overwrite_existing);
+						fs::remove(new_full_dll_path);
+					}
+
+					plugin.info = ReadPluginInfo(plugin.name);
+				}
+				catch (const std::exception& error)
+				{
+					plugin.error = "Plugin " + plugin.name + " - " + error.what();
+				}
+
+				plugin.stage_time = std::chrono::steady_clock::now() - start;
+			}
+		};
+
+		const size_t thread_count = (std::min)(staged.size(), static_cast<size_t>((std::max)(std::thread::hardware_concurrency(), 2u)));
+
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < thread_count; ++i)
+		{
+			threads.emplace_back(stage);
+		}
+
+		stage();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		return staged;
+	}
+
+	std::vector<size_t> PluginManager::SortByDependencies(const std::vector<StagedPlugin>& plugins)
+	{
+		std::unordered_map<std::string, size_t> index_by_name;
+		for (size_t i = 0; i < plugins.size(); ++i)
+		{
+			index_by_name.emplace(plugins[i].name, i);
+		}
+
+		// Edges point from a dependency to the plugins requiring it, unknown dependencies are reported after loading
+		std::vector<std::vector<size_t>> dependents(plugins.size());
+		std::vector<size_t> pending_dependencies(plugins.size(), 0);
+
+		for (size_t i = 0; i < plugins.size(); ++i)
+		{
+			if (!plugins[i].error.empty())
+				continue;
+
+			for (const std::string& dependency : plugins[i].info.value("Dependencies", std::vector<std::string>{}))
+			{
+				const auto iter = index_by_name.find(dependency);
+				if (iter == index_by_name.end() || iter->second == i)
+					continue;
+
+				dependents[iter->second].push_back(i);
+				++pending_dependencies[i];
+			}
+		}
+
+		// Kahn's algorithm, ready plugins keep their directory order
+		std::vector<size_t> order;
+		std::vector<size_t> ready;
+		for (size_t i = 0; i < plugins.size(); ++i)
+		{
+			if (pending_dependencies[i] == 0)
+				ready.push_back(i);
+		}
+
+		while (!ready.empty())
+		{
+			std::sort(ready.begin(), ready.end(), std::greater<>());
+
+			const size_t current = ready.back();
+			ready.pop_back();
+			order.push_back(current);
+
+			for (const size_t dependent : dependents[current])
+			{
+				if (--pending_dependencies[dependent] == 0)
+					ready.push_back(dependent);
+			}
+		}
+
+		if (order.size() != plugins.size())
+		{
+			for (size_t i = 0; i < plugins.size(); ++i)
+			{
+				if (pending_dependencies[i] == 0)
+					continue;
+
+				Log::GetLog()->error("'{}' is in or depends on a plugin dependency cycle, loading it without ordering", plugins[i].name);
+				order.push_back(i);
+			}
 		}
 
-		Log::GetLog()->info("Loaded all plugins\n");
+		return order;
 	}
 
 	std::shared_ptr<Plugin>& PluginManager::LoadPlugin(const std::string& plugin_name) noexcept(false)
+	{
+		return LoadPlugin(plugin_name, ReadPluginInfo(plugin_name));
+	}
+
+	std::shared_ptr<Plugin>& PluginManager::LoadPlugin(const std::string& plugin_name, const nlohmann::json& plugin_info,
+		const std::string* handoff_state) noexcept(false)
 	{
 		//MovePDB(plugin_name);
 
@@ -117,10 +267,8 @@ namespace API
 			throw std::runtime_error("Plugin " + plugin_name + " was already loaded");
 		}
 
-		auto plugin_info = ReadPluginInfo(plugin_name);
-
 		// Check version
-		const auto required_version = static_cast<float>(plugin_info["MinApiVersion"]);
+		const auto required_version = static_cast<float>(plugin_info.at("MinApiVersion"));
 		if (required_version != .0f && game_api->GetVersion() < required_version)
 		{
 			throw std::runtime_error("Plugin " + plugin_name + " requires newer API version!");
@@ -153,6 +301,24 @@ namespace API
 				"Failed to load plugin - " + plugin_name + "\nError code: " + std::to_string(GetLastError()));
 		}
 
+		PluginHeapTracker::Get().AddModule(h_module);
+		PluginHookSampler::Get().AddModule(h_module);
+
+		// Hands over the state of the previous instance first so Plugin_Init can skip its cold start
+		if (handoff_state != nullptr)
+		{
+			using pfnPluginImportState = void(__fastcall*)(const std::string&);
+			const auto pfn_import = reinterpret_cast<pfnPluginImportState>(GetProcAddress(h_module, "Plugin_ImportState"));
+			if (pfn_import != nullptr)
+			{
+				pfn_import(*handoff_state);
+			}
+			else
+			{
+				Log::GetLog()->warn("Plugin '{}' does not export Plugin_ImportState, its previous state was dropped", plugin_name);
+			}
+		}
+
 		// Calls Plugin_Init (if found) after loading DLL
 		// Note: DllMain callbacks during LoadLibrary is load-locked so we cannot do things like WaitForMultipleObjects on threads
 		using pfnPluginInit = void(__fastcall*)();
@@ -162,11 +328,23 @@ namespace API
 			pfn_init();
 		}
 
-		return loaded_plugins_.emplace_back(std::make_shared<Plugin>(h_module, plugin_name, plugin_info["FullName"],
-			plugin_info["Description"], plugin_info["Version"],
-			plugin_info["MinApiVersion"],
-			plugin_info["Dependencies"],
+		const std::shared_ptr<Plugin> plugin = loaded_plugins_.emplace_back(std::make_shared<Plugin>(h_module, plugin_name,
+			plugin_info.at("FullName"),
+			plugin_info.at("Description"), plugin_info.at("Version"),
+			plugin_info.at("MinApiVersion"),
+			plugin_info.at("Dependencies"),
 			plugin_info.value("PreventUnloading", false)));
+
+		// Loaded after BeginPlay (reloads, plugins.load), the deferred phases are due right away
+		if (server_ready_)
+		{
+			PreloadClasses(*ConfigService::Get().GetPluginConfig(plugin_name), plugin_name);
+			RunPostBeginPlayInit(*plugin);
+			QueueIdleInit(*plugin);
+		}
+
+		// The phases above may have loaded other plugins and moved the vector
+		return *std::find(loaded_plugins_.begin(), loaded_plugins_.end(), plugin);
 	}
 
 	void PluginManager::UnloadPlugin(const std::string& plugin_name) noexcept(false)
@@ -203,6 +381,12 @@ namespace API
 
 		// Cleans up all pending callbacks to prevent a server crash due to stale invocations after the plugin is unloaded.
 		API::Requests::Get().UnregisterCallbacksForModule((*iter)->h_module);
+		API::WebSockets::Get().CloseConnectionsForModule((*iter)->h_module);
+		API::PluginProfiler::Get().Forget((*iter)->h_module);
+		API::PluginHeapTracker::Get().RemoveModule((*iter)->h_module);
+		API::PluginHookSampler::Get().RemoveModule((*iter)->h_module);
+		API::ConfigService::Get().UnsubscribeModule((*iter)->h_module);
+		AsaApi::ActorRegistry::Get().UntrackModule((*iter)->h_module);
 
 		API::Timer::Get().UnloadTimersFromModule(FString(full_dll_path).Replace(L"/", L"\\"));
 		dynamic_cast<AsaApi::ApiUtils&>(*API::game_api->GetApiUtils()).RemoveMessagingManagerInternal(FString(full_dll_path).Replace(L"/", L"\\"));
@@ -225,6 +409,8 @@ namespace API
 			dll_dir_cookies_.erase(cookieIt);
 		}
 
+		std::erase_if(idle_inits_, [&plugin_name](const IdleInit& idle_init) { return idle_init.plugin_name == plugin_name; });
+
 		loaded_plugins_.erase(remove(loaded_plugins_.begin(), loaded_plugins_.end(), *iter), loaded_plugins_.end());
 		prevent_unload_warned_plugins_.erase(plugin_name);
 	}
@@ -312,78 +498,364 @@ namespace API
 		pluginManager.DetectPluginChanges();
 	}
 
+	void PluginManager::OnServerReady()
+	{
+		if (server_ready_)
+			return;
+
+		server_ready_ = true;
+
+		PreloadClasses(ConfigService::GetSettings(ConfigService::Get().GetConfig()), "API");
+
+		// Copied, a plugin may load or unload others from its handler
+		const std::vector<std::shared_ptr<Plugin>> plugins = loaded_plugins_;
+		for (const auto& plugin : plugins)
+		{
+			PreloadClasses(*ConfigService::Get().GetPluginConfig(plugin->name), plugin->name);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (const auto& plugin : plugins)
+		{
+			RunPostBeginPlayInit(*plugin);
+		}
+
+		const std::chrono::duration<double, std::milli> total_time = std::chrono::steady_clock::now() - start;
+		Log::GetLog()->info("Post-BeginPlay plugin initialization took {:.1f} ms", total_time.count());
+
+		for (const auto& plugin : plugins)
+		{
+			QueueIdleInit(*plugin);
+		}
+	}
+
+	void PluginManager::PreloadClasses(const nlohmann::json& config, const std::string& owner)
+	{
+		if (!config.is_object())
+			return;
+
+		const auto blueprints = config.find("PreloadClasses");
+		if (blueprints == config.end() || !blueprints->is_array() || blueprints->empty())
+			return;
+
+		TArray<FString> paths;
+		for (const auto& blueprint : *blueprints)
+		{
+			if (blueprint.is_string())
+				paths.Add(FString(blueprint.get<std::string>()));
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const int loaded = AsaApi::GetApiUtils().PreloadClasses(paths);
+		const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+		Log::GetLog()->info("Preloaded {}/{} classes for {} in {:.1f} ms", loaded, paths.Num(), owner, time.count());
+	}
+
+	void PluginManager::RunPostBeginPlayInit(const Plugin& plugin)
+	{
+		using pfnPluginInitPostBeginPlay = void(__fastcall*)();
+		const auto pfn_init = reinterpret_cast<pfnPluginInitPostBeginPlay>(
+			GetProcAddress(plugin.h_module, "Plugin_InitPostBeginPlay"));
+		if (pfn_init == nullptr)
+			return;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		try
+		{
+			pfn_init();
+		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) {} - {}", __FUNCTION__, plugin.name, error.what());
+		}
+
+		const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+		Log::GetLog()->info("Post-BeginPlay init of {} took {:.1f} ms", plugin.name, time.count());
+	}
+
+	void PluginManager::QueueIdleInit(const Plugin& plugin)
+	{
+		if (GetProcAddress(plugin.h_module, "Plugin_InitIdle") == nullptr)
+			return;
+
+		if (idle_inits_.empty())
+		{
+			game_api->GetCommands()->AddOnTickCallback(L"PluginIdleInit", [](float) { Get().RunIdleInit(); });
+		}
+
+		idle_inits_.push_back({plugin.name, plugin.h_module});
+	}
+
+	void PluginManager::RunIdleInit()
+	{
+		using pfnPluginInitIdle = bool(__fastcall*)();
+
+		const auto deadline = std::chrono::steady_clock::now() + idle_init_budget_;
+
+		// Round robin, so one plugin with a long queue of work does not hold back the others
+		while (!idle_inits_.empty() && std::chrono::steady_clock::now() < deadline)
+		{
+			if (idle_init_cursor_ >= idle_inits_.size())
+				idle_init_cursor_ = 0;
+
+			// Copied out, the plugin may load or unload plugins from its idle init and move the entries
+			const std::string plugin_name = idle_inits_[idle_init_cursor_].plugin_name;
+			const HMODULE h_module = idle_inits_[idle_init_cursor_].h_module;
+
+			const auto plugin_iter = FindPlugin(plugin_name);
+			if (plugin_iter == loaded_plugins_.end() || (*plugin_iter)->h_module != h_module)
+			{
+				idle_inits_.erase(idle_inits_.begin() + static_cast<std::ptrdiff_t>(idle_init_cursor_));
+				continue;
+			}
+
+			const auto pfn_idle = reinterpret_cast<pfnPluginInitIdle>(GetProcAddress(h_module, "Plugin_InitIdle"));
+
+			bool more_work = false;
+			const auto start = std::chrono::steady_clock::now();
+
+			try
+			{
+				more_work = pfn_idle != nullptr && pfn_idle();
+			}
+			catch (const std::exception& error)
+			{
+				Log::GetLog()->warn("({}) {} - {}", __FUNCTION__, plugin_name, error.what());
+			}
+
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+
+			const auto idle_init = std::find_if(idle_inits_.begin(), idle_inits_.end(),
+				[h_module](const IdleInit& entry) { return entry.h_module == h_module; });
+			if (idle_init == idle_inits_.end())
+				continue;
+
+			idle_init->time += elapsed;
+			++idle_init->calls;
+
+			idle_init_cursor_ = static_cast<size_t>(idle_init - idle_inits_.begin());
+
+			if (more_work)
+			{
+				++idle_init_cursor_;
+				continue;
+			}
+
+			const std::chrono::duration<double, std::milli> time = idle_init->time;
+			Log::GetLog()->info("Idle init of {} finished, {:.1f} ms over {} calls", plugin_name, time.count(),
+				idle_init->calls);
+
+			idle_inits_.erase(idle_init);
+		}
+
+		if (idle_inits_.empty())
+		{
+			game_api->GetCommands()->RemoveOnTickCallback(L"PluginIdleInit");
+		}
+	}
+
+	void PluginManager::StartPluginWatcher()
+	{
+		const std::string dir_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins";
+
+		plugin_watcher_ = std::make_unique<DirectoryWatcher>(dir_path, true,
+			[this](const std::filesystem::path& relative_path) { OnPluginFileChanged(relative_path); });
+
+		if (!plugin_watcher_->Start())
+		{
+			Log::GetLog()->warn("Could not watch '{}' (error {}), falling back to polling for plugin updates", dir_path,
+				GetLastError());
+			plugin_watcher_.reset();
+		}
+	}
+
+	void PluginManager::OnPluginFileChanged(const std::filesystem::path& relative_path)
+	{
+		std::lock_guard<std::mutex> lock(pending_reloads_mutex_);
+
+		last_plugin_change_ = std::chrono::steady_clock::now();
+
+		if (relative_path.empty())
+		{
+			rescan_plugins_ = true;
+			return;
+		}
+
+		// Only <Plugins>/<name>/<name>.dll.ArkApi triggers a reload
+		const auto first = relative_path.begin();
+		if (first == relative_path.end() || std::next(first) == relative_path.end())
+			return;
+
+		const std::string plugin_name = first->generic_string();
+		if (relative_path.filename().generic_string() == plugin_name + ".dll.ArkApi")
+			pending_reloads_.insert(plugin_name);
+	}
+
 	void PluginManager::DetectPluginChanges()
 	{
 		namespace fs = std::filesystem;
 
+		std::set<std::string> pending;
+		bool rescan = plugin_watcher_ == nullptr || !plugin_watcher_->IsRunning();
+
+		{
+			std::lock_guard<std::mutex> lock(pending_reloads_mutex_);
+
+			// A copy raises several notifications, wait until the writer went quiet
+			if (!rescan && std::chrono::steady_clock::now() - last_plugin_change_ < std::chrono::seconds(1))
+				return;
+
+			pending.swap(pending_reloads_);
+			rescan = std::exchange(rescan_plugins_, false) || rescan;
+		}
+
+		if (rescan)
+		{
+			for (const auto& dir_name : fs::directory_iterator(
+				Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins"))
+			{
+				if (is_directory(dir_name.path()))
+					pending.insert(dir_name.path().filename().stem().generic_string());
+			}
+		}
+
 		// Prevents saving world multiple times if multiple plugins are queued to be reloaded
 		bool save_world = save_world_before_reload_;
 
-		for (const auto& dir_name : fs::directory_iterator(
-			Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins"))
+		// Plugins handing their state over in memory do not need the world save as a safety net
+		if (save_world)
 		{
-			const auto& path = dir_name.path();
-			if (!is_directory(path))
+			save_world = std::any_of(pending.begin(), pending.end(), [this](const std::string& plugin_name)
 			{
-				continue;
-			}
+				const std::string update_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" +
+					plugin_name + "/" + plugin_name + ".dll.ArkApi";
+
+				const auto plugin_iter = FindPlugin(plugin_name);
+
+				return plugin_iter != loaded_plugins_.end() && !(*plugin_iter)->prevent_unloading && fs::exists(update_path)
+					&& !SupportsStateHandoff(plugin_name);
+			});
+		}
+
+		std::vector<std::string> busy;
+		for (const std::string& plugin_name : pending)
+		{
+			if (!ReloadChangedPlugin(plugin_name, save_world))
+				busy.push_back(plugin_name);
+		}
+
+		if (!busy.empty())
+		{
+			std::lock_guard<std::mutex> lock(pending_reloads_mutex_);
+			pending_reloads_.insert(busy.begin(), busy.end());
+		}
+	}
+
+	bool PluginManager::ReloadChangedPlugin(const std::string& plugin_name, bool& save_world)
+	{
+		namespace fs = std::filesystem;
 
-			const auto filename = path.filename().stem().generic_string();
+		const std::string plugin_folder = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" + plugin_name + "/";
 
-			const std::string plugin_folder = path.generic_string() + "/";
+		const std::string plugin_file_path = plugin_folder + plugin_name + ".dll";
+		const std::string new_plugin_file_path = plugin_folder + plugin_name + ".dll.ArkApi";
 
-			const std::string plugin_file_path = plugin_folder + filename + ".dll";
-			const std::string new_plugin_file_path = plugin_folder + filename + ".dll.ArkApi";
+		const auto plugin_iter = FindPlugin(plugin_name);
+		if (!fs::exists(new_plugin_file_path) || plugin_iter == loaded_plugins_.end())
+		{
+			return true;
+		}
 
-			const auto plugin_iter = FindPlugin(filename);
-			if (fs::exists(new_plugin_file_path) && plugin_iter != loaded_plugins_.end())
+		// Reads the loaded plugin's flag, not the pending .dll.ArkApi update
+		if ((*plugin_iter)->prevent_unloading)
+		{
+			if (prevent_unload_warned_plugins_.insert(plugin_name).second)
 			{
-				// Reads the loaded plugin's flag, not the pending .dll.ArkApi update
-				if ((*plugin_iter)->prevent_unloading)
-				{
-					if (prevent_unload_warned_plugins_.insert(filename).second)
-					{
-						Log::GetLog()->warn(
-							"Plugin '{}' has PreventUnloading=true. "
-							"Update pending - restart the server to apply {}.dll.ArkApi.",
-							filename, filename);
-					}
-					continue;
-				}
+				Log::GetLog()->warn(
+					"Plugin '{}' has PreventUnloading=true. "
+					"Update pending - restart the server to apply {}.dll.ArkApi.",
+					plugin_name, plugin_name);
+			}
+			return true;
+		}
+
+		// The update is still being copied when it cannot be opened exclusively
+		const std::wstring new_plugin_file_wpath(new_plugin_file_path.begin(), new_plugin_file_path.end());
+		const HANDLE update = CreateFileW(new_plugin_file_wpath.c_str(), GENERIC_READ, 0, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (update == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		CloseHandle(update);
 
 #ifndef ATLAS_GAME // not on ATLAS
-				// Save the world in case the unload/load procedure causes crash
-				if (save_world)
-				{
-					Log::GetLog()->info("Saving world before reloading plugins");
-					AsaApi::GetApiUtils().GetShooterGameMode()->SaveWorld(true, true, false);
-					Log::GetLog()->info("World saved.");
+		// Save the world in case the unload/load procedure causes crash
+		if (save_world)
+		{
+			Log::GetLog()->info("Saving world before reloading plugins");
+			AsaApi::GetApiUtils().GetShooterGameMode()->SaveWorld(true, true, false);
+			Log::GetLog()->info("World saved.");
 
-					save_world = false; // do not save again if multiple plugins are reloaded in this loop
-				}
+			save_world = false; // do not save again if multiple plugins are reloaded in this loop
+		}
 #endif
-				try
-				{
-					UnloadPlugin(filename);
+		try
+		{
+			std::string state;
+			const bool handoff = SupportsStateHandoff(plugin_name);
+			if (handoff)
+			{
+				using pfnPluginExportState = void(__fastcall*)(std::string&);
+				const auto pfn_export = reinterpret_cast<pfnPluginExportState>(
+					GetProcAddress((*plugin_iter)->h_module, "Plugin_ExportState"));
 
-					copy_file(new_plugin_file_path, plugin_file_path, fs::copy_options::overwrite_existing);
-					fs::remove(new_plugin_file_path);
+				pfn_export(state);
+			}
 
-					// Wait 1 second before loading to let things clean up correctly...
-					// This will load the plugin in the next timer callback
-					//auto_reload_pending_plugins_.emplace_back(filename);
+			UnloadPlugin(plugin_name);
 
-					LoadPlugin(filename);
+			copy_file(new_plugin_file_path, plugin_file_path, fs::copy_options::overwrite_existing);
+			fs::remove(new_plugin_file_path);
 
-					Log::GetLog()->info("Reloaded plugin - {}", filename);
-				}
-				catch (const std::exception& error)
-				{
-					Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
-					continue;
-				}
-			}
+			LoadPlugin(plugin_name, ReadPluginInfo(plugin_name), handoff ? &state : nullptr);
+
+			if (handoff)
+				Log::GetLog()->info("Reloaded plugin - {} (handed over {} bytes of state)", plugin_name, state.size());
+			else
+				Log::GetLog()->info("Reloaded plugin - {}", plugin_name);
 		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+		}
+
+		return true;
+	}
+
+	bool PluginManager::SupportsStateHandoff(const std::string& plugin_name)
+	{
+		const auto iter = FindPlugin(plugin_name);
+		if (iter == loaded_plugins_.end() || GetProcAddress((*iter)->h_module, "Plugin_ExportState") == nullptr)
+			return false;
+
+		// The update has to take the state, otherwise it is dropped after the world save was skipped
+		const std::string update_path = Tools::GetCurrentDir() + "/" + game_api->GetApiName() + "/Plugins/" +
+			plugin_name + "/" + plugin_name + ".dll.ArkApi";
+		const std::wstring update_wpath(update_path.begin(), update_path.end());
+
+		// Maps the image without running DllMain or loading its imports, only the export table is read
+		const HMODULE update = LoadLibraryExW(update_wpath.c_str(), nullptr, DONT_RESOLVE_DLL_REFERENCES);
+		if (update == nullptr)
+			return false;
+
+		const bool imports = GetProcAddress(update, "Plugin_ImportState") != nullptr;
+		FreeLibrary(update);
+
+		return imports;
 	}
 
 	void PluginManager::MovePDB(const std::string& pluginname)
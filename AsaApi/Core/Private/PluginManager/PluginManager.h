@@ -2,7 +2,9 @@
 
 #define WIN32_LEAN_AND_MEAN
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -12,6 +14,8 @@
 
 #include "json.hpp"
 
+#include "../Tools/DirectoryWatcher.h"
+
 namespace API
 {
 	struct Plugin
@@ -84,16 +88,64 @@ namespace API
 		* \brief Checks for auto plugin reloads
 		*/
 		static void DetectPluginChangesTimerCallback();
+
+		/**
+		 * \brief Runs the deferred initialization phases once the world began play.
+		 *
+		 * Plugins may export `void Plugin_InitPostBeginPlay()`, called once on the game thread after BeginPlay, and
+		 * `bool Plugin_InitIdle()`, called repeatedly from ticks within a time budget for as long as it returns true.
+		 * Plugins loaded after this point run both phases right after Plugin_Init. The `PreloadClasses` arrays of the
+		 * API settings and of the plugin configs are loaded into the class cache before the first phase.
+		 */
+		void OnServerReady();
 	private:
+		/**
+		 * \brief Result of preparing a plugin on a loader thread: pending update applied and PluginInfo.json read
+		 */
+		struct StagedPlugin
+		{
+			std::string name;
+			nlohmann::json info;
+			std::string error;
+			std::chrono::steady_clock::duration stage_time{};
+		};
+
 		PluginManager() = default;
 		~PluginManager() = default;
 
 		static nlohmann::json ReadPluginInfo(const std::string& plugin_name);
-		static nlohmann::json ReadSettingsConfig();
+
+		static std::vector<StagedPlugin> StagePlugins(const std::vector<std::string>& plugin_names);
+		static std::vector<size_t> SortByDependencies(const std::vector<StagedPlugin>& plugins);
+
+		/**
+		 * \brief Loads a plugin with already read PluginInfo.json
+		 * \param handoff_state State exported by the previous instance, passed to Plugin_ImportState before Plugin_Init
+		 */
+		std::shared_ptr<Plugin>& LoadPlugin(const std::string& plugin_name, const nlohmann::json& plugin_info,
+			const std::string* handoff_state = nullptr) noexcept(false);
+
+		/**
+		 * \brief True if the loaded plugin exports Plugin_ExportState and its pending update (.dll.ArkApi) exports
+		 * Plugin_ImportState, so it can be reloaded without a world save.
+		 *
+		 * Contract: `void Plugin_ExportState(std::string& state)` is called on the old instance before Plugin_Unload,
+		 * `void Plugin_ImportState(const std::string& state)` on the new instance before its Plugin_Init.
+		 */
+		bool SupportsStateHandoff(const std::string& plugin_name);
 
 		void CheckPluginsDependencies();
 
 		void DetectPluginChanges();
+		void StartPluginWatcher();
+		void OnPluginFileChanged(const std::filesystem::path& relative_path);
+
+		/**
+		 * \brief Reloads `plugin_name` if an update (.dll.ArkApi) is pending for it
+		 * \param save_world Saves the world first if set, cleared once the world was saved
+		 * \return False if the update is still being written and has to be retried
+		 */
+		bool ReloadChangedPlugin(const std::string& plugin_name, bool& save_world);
 
 		void MovePDB(const std::string& pluginname);
 
@@ -106,6 +158,32 @@ namespace API
 		time_t next_reload_check_{5};
 		std::set<std::string> prevent_unload_warned_plugins_;
 
+		// Filled from the watcher thread, consumed on the game thread
+		std::unique_ptr<DirectoryWatcher> plugin_watcher_;
+		std::mutex pending_reloads_mutex_;
+		std::set<std::string> pending_reloads_;
+		bool rescan_plugins_{false};
+		std::chrono::steady_clock::time_point last_plugin_change_;
+
+		// Deferred initialization phases
+		struct IdleInit
+		{
+			std::string plugin_name;
+			HMODULE h_module{nullptr};
+			std::chrono::steady_clock::duration time{};
+			size_t calls{0};
+		};
+
+		static void PreloadClasses(const nlohmann::json& config, const std::string& owner);
+		void RunPostBeginPlayInit(const Plugin& plugin);
+		void QueueIdleInit(const Plugin& plugin);
+		void RunIdleInit();
+
+		bool server_ready_{false};
+		std::chrono::microseconds idle_init_budget_{2000};
+		std::vector<IdleInit> idle_inits_;
+		size_t idle_init_cursor_{0};
+
 		std::unordered_map<std::string, DLL_DIRECTORY_COOKIE> dll_dir_cookies_{};
 		bool dll_search_initialized_{ false };
 	};
@@ -0,0 +1,208 @@
+#include "PluginProfiler.h"
+#include "PluginHeapTracker.h"
+#include "PluginHookSampler.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+#include <Logger/Logger.h>
+
+#include <Psapi.h>
+
+namespace API
+{
+	namespace
+	{
+		thread_local PluginProfiler::Scope* current_scope = nullptr;
+
+		constexpr const char* CategoryNames[] = {
+			"chat", "console", "rcon", "tick", "timer", "chat_msg", "requests", "delayed", "hooks"
+		};
+
+		static_assert(std::size(CategoryNames) == static_cast<size_t>(PluginProfiler::Category::Count));
+
+		std::string GetModuleName(HMODULE module)
+		{
+			wchar_t path[MAX_PATH];
+			if (GetModuleFileNameW(module, path, MAX_PATH) == 0)
+				return fmt::format("{}", static_cast<const void*>(module));
+
+			return std::filesystem::path(path).stem().string();
+		}
+
+		uint64_t GetPrivateBytes()
+		{
+			PROCESS_MEMORY_COUNTERS_EX counters{};
+			if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+				return 0;
+
+			return counters.PrivateUsage;
+		}
+
+		double ToMegabytes(int64_t bytes)
+		{
+			return static_cast<double>(bytes) / (1024.0 * 1024.0);
+		}
+	} // namespace
+
+	PluginProfiler::Scope::Scope(HMODULE module, Category category)
+		: module_(module),
+		category_(category),
+		start_(std::chrono::steady_clock::now()),
+		parent_(current_scope)
+	{
+		current_scope = this;
+
+		if (parent_ == nullptr)
+			PluginHookSampler::SetCallbackActive(true);
+	}
+
+	PluginProfiler::Scope::~Scope()
+	{
+		const auto elapsed = std::chrono::steady_clock::now() - start_;
+
+		current_scope = parent_;
+		if (parent_ != nullptr)
+			parent_->children_ += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+		else
+			PluginHookSampler::SetCallbackActive(false);
+
+		if (module_ != nullptr)
+			PluginProfiler::Get().Record(module_, category_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) - children_);
+	}
+
+	PluginProfiler::PluginProfiler()
+		: started_(std::chrono::steady_clock::now())
+	{
+	}
+
+	PluginProfiler& PluginProfiler::Get()
+	{
+		static PluginProfiler instance;
+		return instance;
+	}
+
+	HMODULE PluginProfiler::ModuleFromAddress(const void* address)
+	{
+		HMODULE module = nullptr;
+		GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+			static_cast<LPCWSTR>(address), &module);
+		return module;
+	}
+
+	int64_t PluginProfiler::CurrentSecond() const
+	{
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started_).count();
+	}
+
+	void PluginProfiler::Record(HMODULE module, Category category, std::chrono::nanoseconds duration)
+	{
+		const int64_t second = CurrentSecond();
+		const auto index = static_cast<size_t>(category);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Bucket& bucket = modules_[module][static_cast<size_t>(second) % WindowSeconds];
+		if (bucket.second != second)
+			bucket = Bucket{second};
+
+		bucket.nanoseconds[index] += static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+		++bucket.calls[index];
+	}
+
+	void PluginProfiler::Forget(HMODULE module)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		modules_.erase(module);
+	}
+
+	std::vector<std::string> PluginProfiler::Describe() const
+	{
+		struct Row
+		{
+			HMODULE module;
+			uint64_t total;
+			std::array<uint64_t, static_cast<size_t>(Category::Count)> nanoseconds;
+			std::array<uint64_t, static_cast<size_t>(Category::Count)> calls;
+		};
+
+		const int64_t now = CurrentSecond();
+		// The running second is incomplete, it is left out so the percentage does not jump
+		const int64_t oldest = now - static_cast<int64_t>(WindowSeconds);
+		const int64_t window = std::clamp<int64_t>(now, 1, WindowSeconds);
+
+		std::vector<Row> rows;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			rows.reserve(modules_.size());
+
+			for (const auto& [module, buckets] : modules_)
+			{
+				Row row{module, 0, {}, {}};
+				for (const Bucket& bucket : buckets)
+				{
+					if (bucket.second < oldest || bucket.second >= now)
+						continue;
+
+					for (size_t i = 0; i < bucket.nanoseconds.size(); ++i)
+					{
+						row.nanoseconds[i] += bucket.nanoseconds[i];
+						row.calls[i] += bucket.calls[i];
+						row.total += bucket.nanoseconds[i];
+					}
+				}
+
+				rows.push_back(row);
+			}
+		}
+
+		// Plugins that only hold memory and never ran a callback in the window are listed too
+		std::unordered_map<HMODULE, PluginHeapTracker::Usage> heaps;
+		for (const PluginHeapTracker::Usage& usage : PluginHeapTracker::Get().GetUsage())
+		{
+			heaps.emplace(usage.module, usage);
+			if (std::none_of(rows.begin(), rows.end(), [&usage](const Row& row) { return row.module == usage.module; }))
+				rows.push_back(Row{usage.module, 0, {}, {}});
+		}
+
+		std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.total > b.total; });
+
+		std::vector<std::string> lines;
+		lines.reserve(rows.size() + 1);
+
+		lines.push_back(fmt::format("Last {}s, process private bytes {:.1f} MB{}{}", window,
+			ToMegabytes(static_cast<int64_t>(GetPrivateBytes())),
+			PluginHeapTracker::Get().IsEnabled() ? "" : " (enable TrackPluginHeap for per plugin heaps)",
+			PluginHookSampler::Get().IsRunning()
+				? ", hooks are sampled (ms/samples)"
+				: " (set PluginHookSamplingHz for time in hooks)"));
+
+		for (const Row& row : rows)
+		{
+			std::string line = fmt::format("{}: {:.2f}% cpu, {:.1f} ms", GetModuleName(row.module),
+				static_cast<double>(row.total) / (window * 1e7), static_cast<double>(row.total) / 1e6);
+
+			const auto heap = heaps.find(row.module);
+			if (heap != heaps.end())
+			{
+				line += fmt::format(", heap {:.2f} MB in {} blocks ({:.1f} MB allocated since load)",
+					ToMegabytes(heap->second.live_bytes), heap->second.live_blocks,
+					ToMegabytes(static_cast<int64_t>(heap->second.allocated_bytes)));
+			}
+
+			for (size_t i = 0; i < row.nanoseconds.size(); ++i)
+			{
+				if (row.calls[i] == 0)
+					continue;
+
+				line += fmt::format(", {} {:.1f} ms/{}", CategoryNames[i], static_cast<double>(row.nanoseconds[i]) / 1e6,
+					row.calls[i]);
+			}
+
+			lines.push_back(std::move(line));
+		}
+
+		return lines;
+	}
+} // namespace API
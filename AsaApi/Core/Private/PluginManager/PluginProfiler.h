@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Windows.h>
+
+namespace API
+{
+	/**
+	 * \brief Attributes the game thread time spent in callbacks to the module that registered them.
+	 *
+	 * Time is kept in one second buckets over a rolling window and is exclusive, a callback that runs other
+	 * callbacks (the timer and requests dispatchers are tick callbacks themselves) is only charged for its own part.
+	 */
+	class PluginProfiler
+	{
+	public:
+		enum class Category : uint8_t
+		{
+			ChatCommand,
+			ConsoleCommand,
+			RconCommand,
+			Tick,
+			Timer,
+			ChatMessage,
+			Request,
+			DelayedTimer,
+			Hook, // Sampled by PluginHookSampler, plugin code on the game thread outside of the callbacks above
+			Count
+		};
+
+		/**
+		 * \brief Charges the lifetime of the scope to a module
+		 */
+		class Scope
+		{
+		public:
+			Scope(HMODULE module, Category category);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			HMODULE module_;
+			Category category_;
+			std::chrono::steady_clock::time_point start_;
+			std::chrono::nanoseconds children_{0};
+			Scope* parent_;
+		};
+
+		static constexpr size_t WindowSeconds = 60;
+
+		static PluginProfiler& Get();
+
+		PluginProfiler(const PluginProfiler&) = delete;
+		PluginProfiler(PluginProfiler&&) = delete;
+		PluginProfiler& operator=(const PluginProfiler&) = delete;
+		PluginProfiler& operator=(PluginProfiler&&) = delete;
+
+		/**
+		 * \brief Resolves the module that contains an address, used to find the plugin behind a registration
+		 */
+		static HMODULE ModuleFromAddress(const void* address);
+
+		void Record(HMODULE module, Category category, std::chrono::nanoseconds duration);
+
+		/**
+		 * \brief Drops the samples of an unloaded module, its handle may be reused by the next load
+		 */
+		void Forget(HMODULE module);
+
+		/**
+		 * \brief One line per module with CPU% of the game thread over the window, busiest first
+		 */
+		std::vector<std::string> Describe() const;
+
+	private:
+		struct Bucket
+		{
+			int64_t second{-1};
+			std::array<uint64_t, static_cast<size_t>(Category::Count)> nanoseconds{};
+			std::array<uint32_t, static_cast<size_t>(Category::Count)> calls{};
+		};
+
+		using Buckets = std::array<Bucket, WindowSeconds>;
+
+		PluginProfiler();
+		~PluginProfiler() = default;
+
+		int64_t CurrentSecond() const;
+
+		const std::chrono::steady_clock::time_point started_;
+
+		mutable std::mutex mutex_;
+		std::unordered_map<HMODULE, Buckets> modules_;
+	};
+} // namespace API
@@ -0,0 +1,151 @@
+#include "Compression.h"
+
+#include <cstdint>
+#include <fstream>
+
+#include <zlib.h>
+
+namespace API
+{
+	namespace Compression
+	{
+		namespace
+		{
+			int InflateWithWindow(std::string_view input, std::string& output, int window_bits, std::string& error)
+			{
+				z_stream stream{};
+				if (inflateInit2(&stream, window_bits) != Z_OK)
+				{
+					error = "inflateInit2 failed";
+					return Z_STREAM_ERROR;
+				}
+
+				stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+				stream.avail_in = static_cast<uInt>(input.size());
+
+				output.clear();
+				char chunk[16384];
+				int status = Z_OK;
+
+				while (status != Z_STREAM_END)
+				{
+					stream.next_out = reinterpret_cast<Bytef*>(chunk);
+					stream.avail_out = sizeof(chunk);
+
+					status = inflate(&stream, Z_NO_FLUSH);
+					if (status != Z_OK && status != Z_STREAM_END)
+					{
+						// Z_BUF_ERROR here means the input ended before the stream did
+						error = stream.msg ? stream.msg : (status == Z_BUF_ERROR ? "truncated stream" : "inflate failed");
+						break;
+					}
+
+					output.append(chunk, sizeof(chunk) - stream.avail_out);
+					if (output.size() > MaxInflatedSize)
+					{
+						error = "inflated size exceeds limit";
+						status = Z_MEM_ERROR;
+						break;
+					}
+				}
+
+				inflateEnd(&stream);
+				return status == Z_STREAM_END ? Z_OK : status;
+			}
+		} // namespace
+
+		bool Inflate(std::string_view input, std::string& output, std::string& error)
+		{
+			if (input.size() > UINT32_MAX)
+			{
+				error = "input too large";
+				return false;
+			}
+
+			// 15 + 32 detects gzip and zlib headers automatically
+			if (InflateWithWindow(input, output, 15 + 32, error) == Z_OK)
+				return true;
+
+			// Some servers send "deflate" as a raw stream without the zlib wrapper
+			std::string raw_error;
+			if (InflateWithWindow(input, output, -15, raw_error) == Z_OK)
+			{
+				error.clear();
+				return true;
+			}
+
+			output.clear();
+			return false;
+		}
+
+		bool GzipFile(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error)
+		{
+			std::ifstream in(source, std::ios::binary);
+			if (!in)
+			{
+				error = "cannot open " + source.string();
+				return false;
+			}
+
+			std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				error = "cannot create " + destination.string();
+				return false;
+			}
+
+			z_stream stream{};
+			// 15 + 16 writes a gzip header instead of a zlib one
+			if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			{
+				error = "deflateInit2 failed";
+				return false;
+			}
+
+			char input[65536];
+			char chunk[65536];
+			int status = Z_OK;
+
+			do
+			{
+				in.read(input, sizeof(input));
+				const bool last = in.eof();
+				if (in.bad())
+				{
+					error = "read failed";
+					status = Z_ERRNO;
+					break;
+				}
+
+				stream.next_in = reinterpret_cast<Bytef*>(input);
+				stream.avail_in = static_cast<uInt>(in.gcount());
+
+				do
+				{
+					stream.next_out = reinterpret_cast<Bytef*>(chunk);
+					stream.avail_out = sizeof(chunk);
+
+					status = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+					out.write(chunk, sizeof(chunk) - stream.avail_out);
+				}
+				while (stream.avail_out == 0);
+			}
+			while (status == Z_OK);
+
+			deflateEnd(&stream);
+			out.close();
+
+			if (status != Z_STREAM_END || !out)
+			{
+				if (error.empty())
+					error = "deflate failed";
+
+				std::error_code ignored;
+				std::filesystem::remove(destination, ignored);
+				return false;
+			}
+
+			return true;
+		}
+	} // namespace Compression
+} // namespace API
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace API
+{
+	namespace Compression
+	{
+		/**
+		 * \brief Upper bound for a single inflated payload, guards against decompression bombs
+		 */
+		constexpr size_t MaxInflatedSize = 256ull * 1024 * 1024;
+
+		/**
+		 * \brief Inflates a gzip, zlib or raw deflate stream (the header is auto detected)
+		 * \param input Compressed bytes
+		 * \param output Receives the inflated bytes
+		 * \param error Receives a description if inflating failed
+		 * \return True on success
+		 */
+		bool Inflate(std::string_view input, std::string& output, std::string& error);
+
+		/**
+		 * \brief Writes `source` gzip compressed to `destination`, streaming in chunks
+		 * \param error Receives a description if compressing failed
+		 * \return True on success, a partially written destination is removed on failure
+		 */
+		bool GzipFile(const std::filesystem::path& source, const std::filesystem::path& destination, std::string& error);
+	} // namespace Compression
+} // namespace API
@@ -0,0 +1,410 @@
+#include <ConfigService.h>
+
+#include "../IBaseApi.h"
+#include "DirectoryWatcher.h"
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <intrin.h>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace API
+{
+	namespace fs = std::filesystem;
+
+	namespace
+	{
+		// Editors write a file in several steps, it is parsed once it was quiet for this long
+		constexpr auto QuietPeriod = std::chrono::milliseconds(500);
+
+		std::optional<HMODULE> TryGetModuleHandleFromAddress(void* address)
+		{
+			HMODULE HModule = nullptr;
+
+			if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)address, &HModule))
+			{
+				return HModule;
+			}
+
+			return std::nullopt;
+		}
+
+		// Entries are keyed by the lower case plugin name, the API config.json uses the empty key
+		std::string MakeKey(const std::string& plugin_name)
+		{
+			std::string key = plugin_name;
+			std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return key;
+		}
+
+		fs::path GetPluginsDir()
+		{
+			return fs::path(Tools::GetCurrentDir()) / game_api->GetApiName() / "Plugins";
+		}
+
+		fs::path GetConfigPath(const std::string& key)
+		{
+			if (key.empty())
+				return fs::path(Tools::GetCurrentDir()) / "config.json";
+
+			return GetPluginsDir() / key / "config.json";
+		}
+	} // namespace
+
+	class ConfigService::impl
+	{
+	public:
+		~impl();
+
+		Snapshot Get(const std::string& key);
+		uint64_t Subscribe(const std::string& key, const Callback& callback, HMODULE pluginModule);
+		void Unsubscribe(uint64_t subscriptionId);
+		void UnsubscribeModule(HMODULE pluginModule);
+
+		void Start();
+		void Update();
+
+	private:
+		struct Entry
+		{
+			Snapshot snapshot;
+			fs::file_time_type write_time;
+		};
+
+		struct Subscription
+		{
+			std::string key;
+			Callback callback;
+			HMODULE pluginModule;
+		};
+
+		// Parses the file into `entry`, false if it could not be parsed and only the write time was set
+		static bool Load(const std::string& key, Entry& entry, std::string& error);
+
+		void OnRootChanged(const fs::path& relative_path);
+		void OnPluginsChanged(const fs::path& relative_path);
+		void MarkChanged(const std::string& key);
+
+		bool IsWatching() const;
+
+		std::unordered_map<std::string, Entry> Entries_;
+		std::mutex EntriesMutex_;
+
+		std::unordered_map<uint64_t, Subscription> Subscriptions_;
+		std::mutex SubscriptionsMutex_;
+		std::atomic<uint64_t> NextId_{1};
+
+		std::unordered_map<std::string, std::chrono::steady_clock::time_point> PendingChanges_;
+		bool RescanAll_{false};
+		std::mutex PendingMutex_;
+
+		std::unique_ptr<DirectoryWatcher> RootWatcher_;
+		std::unique_ptr<DirectoryWatcher> PluginsWatcher_;
+
+		std::string StartupError_;
+	};
+
+	// --- PIMPL ---
+
+	ConfigService::ConfigService()
+		: pimpl{ std::make_unique<impl>() }
+	{
+	}
+
+	ConfigService::~ConfigService() = default;
+
+	ConfigService& ConfigService::Get()
+	{
+		static ConfigService instance;
+		return instance;
+	}
+
+	ConfigService::Snapshot ConfigService::GetConfig()
+	{
+		return pimpl->Get({});
+	}
+
+	const nlohmann::json& ConfigService::GetSettings(const Snapshot& config)
+	{
+		static const nlohmann::json empty = nlohmann::json::object();
+
+		if (!config || !config->is_object())
+			return empty;
+
+		const auto iter = config->find("settings");
+		return iter != config->end() && iter->is_object() ? *iter : empty;
+	}
+
+	ConfigService::Snapshot ConfigService::GetPluginConfig(const std::string& plugin_name)
+	{
+		return pimpl->Get(MakeKey(plugin_name));
+	}
+
+	uint64_t ConfigService::Subscribe(const std::string& plugin_name, const Callback& callback)
+	{
+		auto HModuleOpt = TryGetModuleHandleFromAddress(_ReturnAddress());
+		if (!HModuleOpt) {
+			Log::GetLog()->error(
+				"Failed to get module handle for caller of ConfigService::Subscribe. Subscription cancelled. Error code: {}", GetLastError());
+			return 0;
+		}
+
+		// Changes are only looked for in configs that were read
+		const std::string key = MakeKey(plugin_name);
+		pimpl->Get(key);
+
+		return pimpl->Subscribe(key, callback, *HModuleOpt);
+	}
+
+	void ConfigService::Unsubscribe(uint64_t subscriptionId)
+	{
+		pimpl->Unsubscribe(subscriptionId);
+	}
+
+	void ConfigService::UnsubscribeModule(HMODULE pluginModule)
+	{
+		pimpl->UnsubscribeModule(pluginModule);
+	}
+
+	void ConfigService::Start()
+	{
+		pimpl->Start();
+	}
+
+	// --- IMPL ---
+
+	ConfigService::impl::~impl()
+	{
+		// Watcher callbacks use this object, the threads have to be gone first
+		RootWatcher_.reset();
+		PluginsWatcher_.reset();
+	}
+
+	bool ConfigService::impl::Load(const std::string& key, Entry& entry, std::string& error)
+	{
+		const fs::path path = GetConfigPath(key);
+
+		// Also set on failure, a broken file is not parsed again until it is written
+		std::error_code ec;
+		entry.write_time = fs::last_write_time(path, ec);
+
+		std::ifstream file{ path };
+		if (!file.is_open())
+		{
+			entry.snapshot = std::make_shared<const nlohmann::json>(nlohmann::json::object());
+			return true;
+		}
+
+		try
+		{
+			auto config = std::make_shared<nlohmann::json>();
+			file >> *config;
+
+			entry.snapshot = std::move(config);
+			return true;
+		}
+		catch (const std::exception& exception)
+		{
+			error = path.string() + ": " + exception.what();
+			return false;
+		}
+	}
+
+	bool ConfigService::impl::IsWatching() const
+	{
+		return RootWatcher_ && RootWatcher_->IsRunning() && PluginsWatcher_ && PluginsWatcher_->IsRunning();
+	}
+
+	ConfigService::Snapshot ConfigService::impl::Get(const std::string& key)
+	{
+		std::lock_guard<std::mutex> lock(EntriesMutex_);
+
+		auto iter = Entries_.find(key);
+		if (iter != Entries_.end())
+		{
+			// Without a watcher (not started yet or failed) edits are picked up by comparing the write time
+			std::error_code ec;
+			if (IsWatching() || fs::last_write_time(GetConfigPath(key), ec) == iter->second.write_time)
+				return iter->second.snapshot;
+		}
+
+		Entry entry;
+		std::string error;
+		if (!Load(key, entry, error))
+		{
+			// The logger is not up while the logger reads its own settings, Start() reports it later
+			if (Log::GetLog())
+				Log::GetLog()->error("({}) {}", __FUNCTION__, error);
+			else
+				StartupError_ = error;
+
+			entry.snapshot = iter != Entries_.end()
+				? iter->second.snapshot
+				: std::make_shared<const nlohmann::json>(nlohmann::json::object());
+		}
+
+		Entries_[key] = entry;
+		return entry.snapshot;
+	}
+
+	uint64_t ConfigService::impl::Subscribe(const std::string& key, const Callback& callback, HMODULE pluginModule)
+	{
+		std::lock_guard<std::mutex> lock(SubscriptionsMutex_);
+		const uint64_t subscriptionId = NextId_.fetch_add(1);
+		Subscriptions_.emplace(subscriptionId, Subscription{key, callback, pluginModule});
+		return subscriptionId;
+	}
+
+	void ConfigService::impl::Unsubscribe(uint64_t subscriptionId)
+	{
+		std::lock_guard<std::mutex> lock(SubscriptionsMutex_);
+		Subscriptions_.erase(subscriptionId);
+	}
+
+	void ConfigService::impl::UnsubscribeModule(HMODULE pluginModule)
+	{
+		std::lock_guard<std::mutex> lock(SubscriptionsMutex_);
+		std::erase_if(Subscriptions_, [pluginModule](const auto& entry) {
+			return entry.second.pluginModule == pluginModule;
+		});
+	}
+
+	void ConfigService::impl::Start()
+	{
+		if (!StartupError_.empty())
+		{
+			Log::GetLog()->error("({}) {}", __FUNCTION__, StartupError_);
+			StartupError_.clear();
+		}
+
+		RootWatcher_ = std::make_unique<DirectoryWatcher>(Tools::GetCurrentDir(), false,
+			[this](const fs::path& relative_path) { OnRootChanged(relative_path); });
+		PluginsWatcher_ = std::make_unique<DirectoryWatcher>(GetPluginsDir(), true,
+			[this](const fs::path& relative_path) { OnPluginsChanged(relative_path); });
+
+		if (!RootWatcher_->Start() || !PluginsWatcher_->Start())
+			Log::GetLog()->warn("({}) Config files cannot be watched, changes are picked up when they are read", __FUNCTION__);
+
+		game_api->GetCommands()->AddOnTimerCallback("ConfigServiceUpdate", std::bind(&impl::Update, this));
+	}
+
+	void ConfigService::impl::OnRootChanged(const fs::path& relative_path)
+	{
+		if (relative_path.empty() || _wcsicmp(relative_path.c_str(), L"config.json") == 0)
+			MarkChanged({});
+	}
+
+	void ConfigService::impl::OnPluginsChanged(const fs::path& relative_path)
+	{
+		if (relative_path.empty())
+		{
+			std::lock_guard<std::mutex> lock(PendingMutex_);
+			RescanAll_ = true;
+			return;
+		}
+
+		// <plugin>\config.json, nested files of a plugin are not configs
+		auto iter = relative_path.begin();
+		const fs::path plugin = *iter++;
+		if (iter == relative_path.end() || _wcsicmp(iter->c_str(), L"config.json") != 0 || ++iter != relative_path.end())
+			return;
+
+		MarkChanged(MakeKey(plugin.string()));
+	}
+
+	void ConfigService::impl::MarkChanged(const std::string& key)
+	{
+		std::lock_guard<std::mutex> lock(PendingMutex_);
+		PendingChanges_[key] = std::chrono::steady_clock::now();
+	}
+
+	void ConfigService::impl::Update()
+	{
+		std::vector<std::string> changed;
+		{
+			std::lock_guard<std::mutex> lock(PendingMutex_);
+
+			if (RescanAll_)
+			{
+				// Notifications were dropped, every config that was read so far may have changed
+				RescanAll_ = false;
+
+				std::lock_guard<std::mutex> entries_lock(EntriesMutex_);
+				for (const auto& [key, entry] : Entries_)
+					PendingChanges_.try_emplace(key, std::chrono::steady_clock::time_point{});
+			}
+
+			const auto now = std::chrono::steady_clock::now();
+			for (auto iter = PendingChanges_.begin(); iter != PendingChanges_.end();)
+			{
+				if (now - iter->second < QuietPeriod)
+				{
+					++iter;
+					continue;
+				}
+
+				changed.push_back(iter->first);
+				iter = PendingChanges_.erase(iter);
+			}
+		}
+
+		for (const std::string& key : changed)
+		{
+			Entry entry;
+			std::string error;
+			const bool loaded = Load(key, entry, error);
+
+			{
+				std::lock_guard<std::mutex> lock(EntriesMutex_);
+
+				auto iter = Entries_.find(key);
+				if (iter == Entries_.end())
+					continue;
+
+				if (!loaded || *iter->second.snapshot == *entry.snapshot)
+				{
+					iter->second.write_time = entry.write_time;
+
+					if (!loaded)
+						Log::GetLog()->warn("({}) Keeping the previous config, {}", __FUNCTION__, error);
+					continue;
+				}
+
+				iter->second = entry;
+			}
+
+			Log::GetLog()->info("Reloaded {}", GetConfigPath(key).string());
+
+			std::vector<Callback> callbacks;
+			{
+				std::lock_guard<std::mutex> lock(SubscriptionsMutex_);
+				for (const auto& [id, subscription] : Subscriptions_)
+				{
+					if (subscription.key == key)
+						callbacks.push_back(subscription.callback);
+				}
+			}
+
+			for (const Callback& callback : callbacks)
+			{
+				try
+				{
+					callback(entry.snapshot);
+				}
+				catch (const std::exception& exception)
+				{
+					Log::GetLog()->error("({}) Config subscriber failed: {}", __FUNCTION__, exception.what());
+				}
+			}
+		}
+	}
+} // namespace API
@@ -0,0 +1,121 @@
+#include "DirectoryWatcher.h"
+
+#include <vector>
+
+#include <Windows.h>
+
+namespace API
+{
+	DirectoryWatcher::DirectoryWatcher(std::filesystem::path directory, bool recursive, Callback callback)
+		: directory_(std::move(directory)),
+		recursive_(recursive),
+		callback_(std::move(callback))
+	{
+	}
+
+	DirectoryWatcher::~DirectoryWatcher()
+	{
+		Stop();
+	}
+
+	bool DirectoryWatcher::Start()
+	{
+		Stop();
+
+		const HANDLE directory = CreateFileW(directory_.wstring().c_str(), FILE_LIST_DIRECTORY,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+			FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (directory == INVALID_HANDLE_VALUE)
+			return false;
+
+		directory_handle_ = directory;
+		stop_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+		running_ = true;
+		worker_ = std::thread(&DirectoryWatcher::Run, this);
+
+		return true;
+	}
+
+	void DirectoryWatcher::Stop()
+	{
+		if (stop_event_ != nullptr)
+			SetEvent(stop_event_);
+
+		if (worker_.joinable())
+			worker_.join();
+
+		if (directory_handle_ != nullptr)
+		{
+			CloseHandle(directory_handle_);
+			directory_handle_ = nullptr;
+		}
+
+		if (stop_event_ != nullptr)
+		{
+			CloseHandle(stop_event_);
+			stop_event_ = nullptr;
+		}
+
+		running_ = false;
+	}
+
+	void DirectoryWatcher::Run()
+	{
+		constexpr DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE
+			| FILE_NOTIFY_CHANGE_SIZE;
+
+		// FILE_NOTIFY_INFORMATION records have to be DWORD aligned
+		std::vector<DWORD> buffer(16 * 1024);
+
+		OVERLAPPED overlapped{};
+		overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+		const HANDLE handles[] = {stop_event_, overlapped.hEvent};
+
+		for (;;)
+		{
+			ResetEvent(overlapped.hEvent);
+
+			if (!ReadDirectoryChangesW(directory_handle_, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)),
+				recursive_, filter, nullptr, &overlapped, nullptr))
+			{
+				break;
+			}
+
+			DWORD transferred = 0;
+
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+			{
+				CancelIoEx(directory_handle_, &overlapped);
+				GetOverlappedResult(directory_handle_, &overlapped, &transferred, TRUE);
+				break;
+			}
+
+			if (!GetOverlappedResult(directory_handle_, &overlapped, &transferred, FALSE))
+				break;
+
+			if (transferred == 0)
+			{
+				// More changes than fit into the buffer, the caller has to look at everything
+				callback_({});
+				continue;
+			}
+
+			const auto* bytes = reinterpret_cast<const BYTE*>(buffer.data());
+			for (;;)
+			{
+				const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(bytes);
+				callback_(std::filesystem::path(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR))));
+
+				if (info->NextEntryOffset == 0)
+					break;
+
+				bytes += info->NextEntryOffset;
+			}
+		}
+
+		CloseHandle(overlapped.hEvent);
+		running_ = false;
+	}
+} // namespace API
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+namespace API
+{
+	/**
+	 * \brief Watches a directory tree with ReadDirectoryChangesW on a background thread.
+	 *
+	 * The callback runs on the watcher thread with the changed path relative to the watched directory. An empty
+	 * path means the system dropped notifications (buffer overflow) and the caller has to rescan.
+	 */
+	class DirectoryWatcher
+	{
+	public:
+		using Callback = std::function<void(const std::filesystem::path& relative_path)>;
+
+		DirectoryWatcher(std::filesystem::path directory, bool recursive, Callback callback);
+		~DirectoryWatcher();
+
+		DirectoryWatcher(const DirectoryWatcher&) = delete;
+		DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+		/**
+		 * \brief Opens the directory and starts the watcher thread
+		 * \return False if the directory cannot be watched
+		 */
+		bool Start();
+		void Stop();
+
+		/**
+		 * \brief False once the watcher thread stopped on an error, changes are no longer reported then
+		 */
+		bool IsRunning() const { return running_; }
+
+	private:
+		void Run();
+
+		const std::filesystem::path directory_;
+		const bool recursive_;
+		const Callback callback_;
+
+		void* directory_handle_{nullptr};
+		void* stop_event_{nullptr};
+		std::atomic<bool> running_{false};
+		std::thread worker_;
+	};
+} // namespace API
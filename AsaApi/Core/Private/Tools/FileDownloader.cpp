@@ -0,0 +1,456 @@
+#define WIN32_LEAN_AND_MEAN
+
+#include "FileDownloader.h"
+
+#include "../Cache.h"
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+#include "Poco/Exception.h"
+#include "Poco/NullStream.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/String.h"
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPSClientSession.h"
+
+namespace API
+{
+	namespace fs = std::filesystem;
+
+	namespace
+	{
+		// Files smaller than this per connection are not worth splitting further
+		constexpr uint64_t MinSegmentSize = 1024 * 1024;
+		constexpr int MaxSegmentRetries = 4;
+
+		std::unique_ptr<Poco::Net::HTTPClientSession> CreateSession(const Poco::URI& uri)
+		{
+			if (uri.getScheme() == "https")
+				return std::make_unique<Poco::Net::HTTPSClientSession>(uri.getHost(), uri.getPort());
+
+			return std::make_unique<Poco::Net::HTTPClientSession>(uri.getHost(), uri.getPort());
+		}
+
+		Poco::Net::HTTPRequest CreateRequest(const Poco::URI& uri, const std::vector<std::string>& headers)
+		{
+			Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_GET, uri.getPathAndQuery(), Poco::Net::HTTPMessage::HTTP_1_1);
+
+			for (const auto& header : headers)
+			{
+				const std::string& key = header.substr(0, header.find(":"));
+				const std::string& data = header.substr(header.find(":") + 1);
+
+				request.add(key, data);
+			}
+
+			return request;
+		}
+
+		void Drain(std::istream& stream)
+		{
+			Poco::NullOutputStream null;
+			Poco::StreamCopier::copyStream(stream, null);
+		}
+
+		uint64_t SizeOrZero(const fs::path& path)
+		{
+			std::error_code error;
+			const uint64_t size = fs::file_size(path, error);
+			return error ? 0 : size;
+		}
+
+		// Content-Range: bytes <first>-<last>/<total>
+		bool ParseContentRange(const std::string& content_range, uint64_t& first, uint64_t& last, uint64_t& total)
+		{
+			unsigned long long parsed_first = 0;
+			unsigned long long parsed_last = 0;
+			unsigned long long parsed_total = 0;
+
+			if (sscanf_s(content_range.c_str(), "bytes %llu-%llu/%llu", &parsed_first, &parsed_last, &parsed_total) != 3)
+				return false;
+
+			first = parsed_first;
+			last = parsed_last;
+			total = parsed_total;
+			return true;
+		}
+	} // namespace
+
+	FileDownloader::FileDownloader(std::string url, fs::path local_path, std::vector<std::string> headers)
+		: url_(std::move(url)),
+		local_path_(std::move(local_path)),
+		headers_(std::move(headers))
+	{
+		try
+		{
+			host_ = Poco::URI(url_).getHost();
+		}
+		catch (...)
+		{
+			host_ = "<unknown host>";
+		}
+	}
+
+	fs::path FileDownloader::GetPartPath() const
+	{
+		return fs::path(local_path_).concat(".part");
+	}
+
+	fs::path FileDownloader::GetSegmentPath(size_t index) const
+	{
+		return fs::path(local_path_).concat(fmt::format(".part.{}", index));
+	}
+
+	fs::path FileDownloader::GetMetaPath() const
+	{
+		return fs::path(local_path_).concat(".part.meta");
+	}
+
+	bool FileDownloader::Run(const std::string& expected_sha256, int max_segments)
+	{
+		uint64_t size = 0;
+		std::string validator;
+
+		switch (Probe(size, validator))
+		{
+		case ProbeResult::Failed:
+			return false;
+		case ProbeResult::Streamed:
+			DiscardSegments();
+			return Finalize(expected_sha256);
+		case ProbeResult::NoRanges:
+			DiscardSegments();
+			return DownloadStream() && Finalize(expected_sha256);
+		default:
+			break;
+		}
+
+		// Parts on disk can only be reused for the exact same remote file
+		size_t segment_count = 0;
+		{
+			std::ifstream meta(GetMetaPath());
+			uint64_t meta_size = 0;
+			std::string meta_validator;
+
+			if (!(meta >> meta_size >> segment_count) || !std::getline(meta >> std::ws, meta_validator)
+				|| meta_size != size || meta_validator != validator)
+			{
+				segment_count = 0;
+			}
+		}
+
+		if (segment_count == 0 || segment_count > 64)
+		{
+			DiscardSegments();
+
+			const uint64_t by_size = (size + MinSegmentSize - 1) / MinSegmentSize;
+			segment_count = static_cast<size_t>(std::clamp<uint64_t>(by_size, 1, static_cast<uint64_t>((std::max)(1, max_segments))));
+
+			std::ofstream meta(GetMetaPath(), std::ios::trunc);
+			meta << size << " " << segment_count << "\n" << validator << "\n";
+		}
+
+		std::vector<Segment> segments;
+		uint64_t present = 0;
+
+		for (size_t i = 0; i < segment_count; ++i)
+		{
+			const uint64_t begin = size * i / segment_count;
+			const uint64_t end = size * (i + 1) / segment_count - 1;
+
+			segments.push_back({begin, end});
+			present += (std::min)(SizeOrZero(GetSegmentPath(i)), end - begin + 1);
+		}
+
+		Log::GetLog()->info("Downloading '{}' ({:.1f} MB) from '{}' in {} segment(s){}", local_path_.filename().string(),
+			static_cast<double>(size) / (1024.0 * 1024.0), host_, segment_count,
+			present > 0 ? fmt::format(", resuming with {:.1f} MB present", static_cast<double>(present) / (1024.0 * 1024.0)) : "");
+
+		std::atomic<bool> success{true};
+		std::vector<std::thread> workers;
+
+		for (size_t i = 1; i < segment_count; ++i)
+		{
+			workers.emplace_back([this, i, size, &validator, &segments, &success] {
+				if (!DownloadSegment(i, segments[i], size, validator))
+					success = false;
+			});
+		}
+
+		// The first segment runs on the calling thread
+		if (!DownloadSegment(0, segments[0], size, validator))
+			success = false;
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+
+		// Completed segments stay on disk for the next attempt
+		if (!success)
+			return false;
+
+		return Assemble(segment_count, size) && Finalize(expected_sha256);
+	}
+
+	FileDownloader::ProbeResult FileDownloader::Probe(uint64_t& size, std::string& validator)
+	{
+		try
+		{
+			const Poco::URI uri(url_);
+			const auto session = CreateSession(uri);
+
+			Poco::Net::HTTPRequest request = CreateRequest(uri, headers_);
+			request.set("Range", "bytes=0-0");
+
+			session->sendRequest(request);
+
+			Poco::Net::HTTPResponse response;
+			std::istream& stream = session->receiveResponse(response);
+
+			// If-Range only accepts a strong ETag or a date
+			validator = response.get("ETag", "");
+			if (validator.empty() || validator.rfind("W/", 0) == 0)
+				validator = response.get("Last-Modified", "-");
+
+			if (response.getStatus() == Poco::Net::HTTPResponse::HTTP_OK)
+				return StreamTo(stream, GetPartPath(), false) ? ProbeResult::Streamed : ProbeResult::Failed;
+
+			Drain(stream);
+
+			if (response.getStatus() != Poco::Net::HTTPResponse::HTTP_PARTIAL_CONTENT)
+			{
+				Log::GetLog()->error("Downloading '{}' from '{}' failed: {} {}", local_path_.filename().string(), host_,
+					static_cast<int>(response.getStatus()), response.getReason());
+				return ProbeResult::Failed;
+			}
+
+			// Content-Range: bytes 0-0/<size>, the size may be "*" if unknown
+			const std::string content_range = response.get("Content-Range", "");
+			const size_t slash = content_range.rfind('/');
+
+			try
+			{
+				size = slash == std::string::npos ? 0 : std::stoull(content_range.substr(slash + 1));
+			}
+			catch (const std::exception&)
+			{
+				size = 0;
+			}
+
+			return size > 0 ? ProbeResult::Ranged : ProbeResult::NoRanges;
+		}
+		catch (const Poco::Exception& exc)
+		{
+			Log::GetLog()->error("HTTP request to '{}' failed: {}", host_, exc.displayText());
+			return ProbeResult::Failed;
+		}
+	}
+
+	bool FileDownloader::DownloadStream()
+	{
+		try
+		{
+			const Poco::URI uri(url_);
+			const auto session = CreateSession(uri);
+
+			Poco::Net::HTTPRequest request = CreateRequest(uri, headers_);
+			session->sendRequest(request);
+
+			Poco::Net::HTTPResponse response;
+			std::istream& stream = session->receiveResponse(response);
+
+			if (response.getStatus() != Poco::Net::HTTPResponse::HTTP_OK)
+			{
+				Drain(stream);
+				Log::GetLog()->error("Downloading '{}' from '{}' failed: {} {}", local_path_.filename().string(), host_,
+					static_cast<int>(response.getStatus()), response.getReason());
+				return false;
+			}
+
+			return StreamTo(stream, GetPartPath(), false);
+		}
+		catch (const Poco::Exception& exc)
+		{
+			Log::GetLog()->error("HTTP request to '{}' failed: {}", host_, exc.displayText());
+			return false;
+		}
+	}
+
+	bool FileDownloader::StreamTo(std::istream& stream, const fs::path& path, bool append)
+	{
+		std::ofstream out(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+		if (!out)
+		{
+			Log::GetLog()->error("Writing the file '{}' failed", path.string());
+			return false;
+		}
+
+		Poco::StreamCopier::copyStream64(stream, out);
+		return static_cast<bool>(out);
+	}
+
+	void FileDownloader::DiscardSegments()
+	{
+		const std::string prefix = local_path_.filename().string() + ".part.";
+
+		std::error_code error;
+		for (const auto& entry : fs::directory_iterator(local_path_.parent_path(), error))
+		{
+			if (entry.path().filename().string().rfind(prefix, 0) == 0)
+				fs::remove(entry.path(), error);
+		}
+	}
+
+	bool FileDownloader::DownloadSegment(size_t index, const Segment& segment, uint64_t size, const std::string& validator)
+	{
+		const uint64_t length = segment.end - segment.begin + 1;
+		const fs::path path = GetSegmentPath(index);
+
+		for (int attempt = 0;; ++attempt)
+		{
+			uint64_t present = SizeOrZero(path);
+			if (present > length)
+			{
+				std::error_code error;
+				fs::remove(path, error);
+				present = 0;
+			}
+
+			if (present == length)
+				return true;
+
+			if (attempt > MaxSegmentRetries)
+			{
+				Log::GetLog()->error("Downloading segment {} of '{}' from '{}' failed after {} attempts", index,
+					local_path_.filename().string(), host_, attempt);
+				return false;
+			}
+
+			if (attempt > 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(500 * attempt));
+
+			try
+			{
+				const Poco::URI uri(url_);
+				const auto session = CreateSession(uri);
+
+				Poco::Net::HTTPRequest request = CreateRequest(uri, headers_);
+				request.set("Range", fmt::format("bytes={}-{}", segment.begin + present, segment.end));
+
+				// The server sends the whole file instead of the range if it changed since the probe
+				if (validator != "-")
+					request.set("If-Range", validator);
+
+				session->sendRequest(request);
+
+				Poco::Net::HTTPResponse response;
+				std::istream& stream = session->receiveResponse(response);
+
+				if (response.getStatus() != Poco::Net::HTTPResponse::HTTP_PARTIAL_CONTENT)
+				{
+					Drain(stream);
+
+					// A file that changed or a server that stops honoring ranges cannot be resumed, the next
+					// download sees the new validator and starts over
+					if (static_cast<int>(response.getStatus()) < 500)
+					{
+						Log::GetLog()->error("Downloading segment {} of '{}' from '{}' failed: {} {}", index,
+							local_path_.filename().string(), host_, static_cast<int>(response.getStatus()), response.getReason());
+						return false;
+					}
+
+					continue;
+				}
+
+				uint64_t first = 0;
+				uint64_t last = 0;
+				uint64_t total = 0;
+				if (!ParseContentRange(response.get("Content-Range", ""), first, last, total)
+					|| first != segment.begin + present || last != segment.end || total != size)
+				{
+					Drain(stream);
+					Log::GetLog()->error("Downloading segment {} of '{}' from '{}' failed: unexpected Content-Range '{}'",
+						index, local_path_.filename().string(), host_, response.get("Content-Range", ""));
+					return false;
+				}
+
+				if (!StreamTo(stream, path, true))
+					return false;
+			}
+			catch (const Poco::Exception& exc)
+			{
+				Log::GetLog()->warn("Segment {} of '{}' interrupted: {}", index, local_path_.filename().string(), exc.displayText());
+			}
+		}
+	}
+
+	bool FileDownloader::Assemble(size_t segment_count, uint64_t size)
+	{
+		{
+			std::ofstream out(GetPartPath(), std::ios::binary | std::ios::trunc);
+			if (!out)
+			{
+				Log::GetLog()->error("Writing the file '{}' failed", GetPartPath().string());
+				return false;
+			}
+
+			for (size_t i = 0; i < segment_count; ++i)
+			{
+				std::ifstream in(GetSegmentPath(i), std::ios::binary);
+				out << in.rdbuf();
+			}
+		}
+
+		DiscardSegments();
+
+		if (SizeOrZero(GetPartPath()) != size)
+		{
+			Log::GetLog()->error("Downloaded file '{}' has an unexpected size", local_path_.filename().string());
+
+			std::error_code error;
+			fs::remove(GetPartPath(), error);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool FileDownloader::Finalize(const std::string& expected_sha256)
+	{
+		const fs::path part = GetPartPath();
+
+		if (!expected_sha256.empty())
+		{
+			const std::string actual = Cache::calculateSHA256(part);
+			if (Poco::icompare(actual, expected_sha256) != 0)
+			{
+				Log::GetLog()->error("Downloaded file '{}' failed verification, expected SHA-256 {} but got {}",
+					local_path_.filename().string(), expected_sha256, actual.empty() ? "nothing" : actual);
+
+				std::error_code error;
+				fs::remove(part, error);
+				return false;
+			}
+		}
+
+		std::error_code error;
+		fs::remove(local_path_, error);
+		fs::rename(part, local_path_, error);
+		if (error)
+		{
+			Log::GetLog()->error("Moving the downloaded file to '{}' failed: {}", local_path_.string(), error.message());
+			return false;
+		}
+
+		return true;
+	}
+} // namespace API
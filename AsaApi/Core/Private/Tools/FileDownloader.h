@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Downloads a single file using HTTP range requests where the server allows it.
+	 *
+	 * The file is split into segments fetched in parallel, each segment is kept in `<file>.part.<n>` until the
+	 * whole file is present, so an interrupted download resumes where it stopped on the next attempt.
+	 * `<file>.part.meta` remembers the size and validator (ETag / Last-Modified) the parts belong to,
+	 * parts of a file that changed on the server are discarded. Range requests carry the validator in `If-Range`
+	 * and the returned `Content-Range` has to match the segment. Servers without range support get a plain stream.
+	 */
+	class FileDownloader
+	{
+	public:
+		FileDownloader(std::string url, std::filesystem::path local_path, std::vector<std::string> headers);
+
+		/**
+		 * \brief Blocks until the file is complete or the download failed
+		 * \param expected_sha256 Hex SHA-256 of the complete file, empty to skip verification
+		 * \param max_segments Upper bound for parallel connections
+		 * \return True if the file was written to the local path
+		 */
+		bool Run(const std::string& expected_sha256, int max_segments);
+
+	private:
+		struct Segment
+		{
+			uint64_t begin;
+			uint64_t end; // inclusive
+		};
+
+		enum class ProbeResult
+		{
+			Failed,
+			Ranged,   // server answered with 206, segments can be requested
+			Streamed, // server ignored the range and sent the whole file, it is in the part file already
+			NoRanges  // ranges are supported but the size is unknown
+		};
+
+		ProbeResult Probe(uint64_t& size, std::string& validator);
+		bool DownloadStream();
+		bool StreamTo(std::istream& stream, const std::filesystem::path& path, bool append);
+		void DiscardSegments();
+		bool DownloadSegment(size_t index, const Segment& segment, uint64_t size, const std::string& validator);
+		bool Assemble(size_t segment_count, uint64_t size);
+		bool Finalize(const std::string& expected_sha256);
+
+		std::filesystem::path GetPartPath() const;
+		std::filesystem::path GetSegmentPath(size_t index) const;
+		std::filesystem::path GetMetaPath() const;
+
+		std::string url_;
+		std::string host_;
+		std::filesystem::path local_path_;
+		std::vector<std::string> headers_;
+	};
+} // namespace API
@@ -0,0 +1,268 @@
+#include "HostTrafficShaper.h"
+
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+namespace API
+{
+	namespace
+	{
+		std::string ToLower(std::string value)
+		{
+			std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return value;
+		}
+	} // namespace
+
+	HostPolicy HostTrafficShaper::ParsePolicy(const nlohmann::json& json, const HostPolicy& defaults)
+	{
+		HostPolicy policy = defaults;
+		if (!json.is_object())
+			return policy;
+
+		policy.requests_per_second = json.value("RequestsPerSecond", defaults.requests_per_second);
+		policy.burst = (std::max)(1, json.value("Burst", defaults.burst));
+		policy.max_queue_wait_ms = (std::max)(0, json.value("MaxQueueWaitMs", defaults.max_queue_wait_ms));
+		policy.max_retries = (std::max)(0, json.value("MaxRetries", defaults.max_retries));
+		policy.retry_base_delay_ms = (std::max)(1, json.value("RetryBaseDelayMs", defaults.retry_base_delay_ms));
+		policy.retry_max_delay_ms = (std::max)(policy.retry_base_delay_ms, json.value("RetryMaxDelayMs", defaults.retry_max_delay_ms));
+		policy.circuit_failure_threshold = (std::max)(0, json.value("CircuitBreakerFailures", defaults.circuit_failure_threshold));
+		policy.circuit_cooldown_seconds = (std::max)(1, json.value("CircuitBreakerCooldownSeconds", defaults.circuit_cooldown_seconds));
+
+		return policy;
+	}
+
+	void HostTrafficShaper::Configure(const nlohmann::json& settings)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		hosts_.clear();
+		host_policies_.clear();
+		default_policy_ = HostPolicy{};
+
+		if (!settings.is_object())
+			return;
+
+		const nlohmann::json shaping = settings.value("HttpTrafficShaping", nlohmann::json::object());
+
+		try
+		{
+			enabled_ = shaping.value("Enable", true);
+			default_policy_ = ParsePolicy(shaping.value("Default", nlohmann::json::object()), HostPolicy{});
+
+			for (const auto& [host, policy] : shaping.value("Hosts", nlohmann::json::object()).items())
+			{
+				host_policies_[ToLower(host)] = ParsePolicy(policy, default_policy_);
+			}
+		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) Invalid HttpTrafficShaping settings, using defaults: {}", __FUNCTION__, error.what());
+			enabled_ = true;
+			default_policy_ = HostPolicy{};
+			host_policies_.clear();
+		}
+	}
+
+	HostTrafficShaper::HostState& HostTrafficShaper::GetState(const std::string& host)
+	{
+		auto iter = hosts_.find(host);
+		if (iter != hosts_.end())
+			return iter->second;
+
+		HostState state;
+		const auto policy_iter = host_policies_.find(host);
+		state.policy = policy_iter != host_policies_.end() ? policy_iter->second : default_policy_;
+		state.tokens = state.policy.burst;
+		state.last_refill = Clock::now();
+
+		return hosts_.emplace(host, state).first->second;
+	}
+
+	HostTrafficShaper::Admission HostTrafficShaper::Acquire(const std::string& raw_host, bool may_wait)
+	{
+		const std::string host = ToLower(raw_host);
+		std::chrono::milliseconds wait{0};
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			HostState& state = GetState(host);
+
+			if (!enabled_)
+				return Admission::Allowed;
+
+			const auto now = Clock::now();
+
+			if (state.circuit == CircuitState::Open)
+			{
+				if (now < state.open_until)
+				{
+					++state.stats.short_circuited;
+					return Admission::CircuitOpen;
+				}
+
+				state.circuit = CircuitState::HalfOpen;
+				state.probe_in_flight = false;
+			}
+
+			if (state.circuit == CircuitState::HalfOpen)
+			{
+				// Only a single probe is let through until it reports back
+				if (state.probe_in_flight)
+				{
+					++state.stats.short_circuited;
+					return Admission::CircuitOpen;
+				}
+
+				state.probe_in_flight = true;
+			}
+
+			const HostPolicy& policy = state.policy;
+			if (policy.requests_per_second > 0.0)
+			{
+				const double elapsed = std::chrono::duration<double>(now - state.last_refill).count();
+				state.tokens = (std::min)(static_cast<double>(policy.burst), state.tokens + elapsed * policy.requests_per_second);
+				state.last_refill = now;
+
+				// Tokens may go negative, which reserves a slot in the queue for this worker
+				if (state.tokens < 1.0)
+				{
+					wait = std::chrono::milliseconds(static_cast<long long>((1.0 - state.tokens) / policy.requests_per_second * 1000.0));
+					if (!may_wait || wait.count() > policy.max_queue_wait_ms)
+					{
+						++state.stats.rate_limited;
+						if (state.circuit == CircuitState::HalfOpen)
+							state.probe_in_flight = false;
+
+						return Admission::RateLimited;
+					}
+				}
+
+				state.tokens -= 1.0;
+			}
+		}
+
+		if (wait.count() > 0)
+			std::this_thread::sleep_for(wait);
+
+		return Admission::Allowed;
+	}
+
+	void HostTrafficShaper::ReportResult(const std::string& raw_host, bool healthy)
+	{
+		const std::string host = ToLower(raw_host);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		HostState& state = GetState(host);
+
+		if (healthy)
+		{
+			if (state.circuit != CircuitState::Closed)
+				Log::GetLog()->info("HTTP circuit for host '{}' closed, host recovered", host);
+
+			state.circuit = CircuitState::Closed;
+			state.consecutive_failures = 0;
+			state.probe_in_flight = false;
+			return;
+		}
+
+		++state.stats.failures;
+		++state.consecutive_failures;
+
+		if (!enabled_ || state.policy.circuit_failure_threshold == 0)
+			return;
+
+		if (state.circuit == CircuitState::HalfOpen
+			|| (state.circuit == CircuitState::Closed && state.consecutive_failures >= state.policy.circuit_failure_threshold))
+		{
+			if (state.circuit == CircuitState::Closed)
+			{
+				Log::GetLog()->warn("HTTP circuit for host '{}' opened after {} consecutive failures, failing fast for {}s",
+					host, state.consecutive_failures, state.policy.circuit_cooldown_seconds);
+			}
+
+			state.circuit = CircuitState::Open;
+			state.open_until = Clock::now() + std::chrono::seconds(state.policy.circuit_cooldown_seconds);
+			state.probe_in_flight = false;
+		}
+	}
+
+	std::chrono::milliseconds HostTrafficShaper::GetBackoff(const std::string& raw_host, int attempt, int retry_after_seconds)
+	{
+		HostPolicy policy;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			policy = GetState(ToLower(raw_host)).policy;
+		}
+
+		if (retry_after_seconds > 0)
+			return std::chrono::milliseconds((std::min)(retry_after_seconds * 1000, policy.retry_max_delay_ms));
+
+		// Full jitter: uniform in [0, min(max, base * 2^attempt)]
+		const long long ceiling = (std::min)(static_cast<long long>(policy.retry_max_delay_ms),
+			static_cast<long long>(policy.retry_base_delay_ms) << (std::min)(attempt, 20));
+
+		thread_local std::mt19937 generator{std::random_device{}()};
+		std::uniform_int_distribution<long long> distribution(0, ceiling);
+
+		return std::chrono::milliseconds(distribution(generator));
+	}
+
+	int HostTrafficShaper::GetMaxRetries(const std::string& raw_host)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return enabled_ ? GetState(ToLower(raw_host)).policy.max_retries : 0;
+	}
+
+	void HostTrafficShaper::CountRequest(const std::string& raw_host)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++GetState(ToLower(raw_host)).stats.requests;
+	}
+
+	void HostTrafficShaper::CountRetry(const std::string& raw_host)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++GetState(ToLower(raw_host)).stats.retries;
+	}
+
+	void HostTrafficShaper::RecordTransfer(const std::string& raw_host, size_t wire_bytes, size_t decoded_bytes)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		HostStats& stats = GetState(ToLower(raw_host)).stats;
+
+		stats.received_bytes += wire_bytes;
+		if (decoded_bytes > 0)
+		{
+			++stats.compressed_responses;
+			stats.compressed_bytes += wire_bytes;
+			stats.decompressed_bytes += decoded_bytes;
+		}
+	}
+
+	std::vector<std::string> HostTrafficShaper::DescribeHosts()
+	{
+		std::vector<std::string> lines;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const auto& [host, state] : hosts_)
+		{
+			const char* circuit = state.circuit == CircuitState::Closed ? "closed"
+				: state.circuit == CircuitState::Open ? "open" : "half-open";
+
+			const HostStats& stats = state.stats;
+			const double ratio = stats.compressed_bytes > 0
+				? static_cast<double>(stats.decompressed_bytes) / static_cast<double>(stats.compressed_bytes) : 0.0;
+
+			lines.push_back(fmt::format("{}: requests={} failures={} retries={} rate_limited={} short_circuited={} circuit={} "
+				"received={}B compressed={}/{} ratio={:.2f}",
+				host, stats.requests, stats.failures, stats.retries, stats.rate_limited, stats.short_circuited, circuit,
+				stats.received_bytes, stats.compressed_responses, stats.requests, ratio));
+		}
+
+		return lines;
+	}
+} // namespace API
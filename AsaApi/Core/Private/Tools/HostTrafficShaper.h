@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "json.hpp"
+
+namespace API
+{
+	/**
+	 * \brief Traffic policy applied to every request towards a single host
+	 */
+	struct HostPolicy
+	{
+		double requests_per_second{0.0}; // 0 = unlimited
+		int burst{20};
+		int max_queue_wait_ms{5000};
+		int max_retries{2};
+		int retry_base_delay_ms{250};
+		int retry_max_delay_ms{5000};
+		int circuit_failure_threshold{5}; // 0 = circuit breaker disabled
+		int circuit_cooldown_seconds{30};
+	};
+
+	/**
+	 * \brief Per-host token bucket, retry backoff and circuit breaker shared by all request workers.
+	 * All members are thread-safe.
+	 */
+	class HostTrafficShaper
+	{
+	public:
+		enum class Admission
+		{
+			Allowed,
+			RateLimited,
+			CircuitOpen
+		};
+
+		struct HostStats
+		{
+			uint64_t requests{0};
+			uint64_t failures{0};
+			uint64_t retries{0};
+			uint64_t rate_limited{0};
+			uint64_t short_circuited{0};
+			uint64_t received_bytes{0};
+			uint64_t compressed_responses{0};
+			uint64_t compressed_bytes{0};
+			uint64_t decompressed_bytes{0};
+		};
+
+		HostTrafficShaper() = default;
+
+		HostTrafficShaper(const HostTrafficShaper&) = delete;
+		HostTrafficShaper(HostTrafficShaper&&) = delete;
+		HostTrafficShaper& operator=(const HostTrafficShaper&) = delete;
+		HostTrafficShaper& operator=(HostTrafficShaper&&) = delete;
+
+		/**
+		 * \brief Reads the `HttpTrafficShaping` block of the API settings
+		 */
+		void Configure(const nlohmann::json& settings);
+
+		/**
+		 * \brief Takes a token for the host, blocking the calling worker up to `max_queue_wait_ms`
+		 * \param may_wait false to fail with RateLimited instead of blocking, for requests on the game thread
+		 */
+		Admission Acquire(const std::string& host, bool may_wait = true);
+
+		/**
+		 * \brief Feeds the outcome of one attempt into the circuit breaker
+		 * \param healthy false for transport errors, 5xx and 429 responses
+		 */
+		void ReportResult(const std::string& host, bool healthy);
+
+		/**
+		 * \brief Jittered exponential backoff for the given retry attempt (1-based)
+		 * \param retry_after_seconds Server supplied Retry-After hint, 0 if none
+		 */
+		std::chrono::milliseconds GetBackoff(const std::string& host, int attempt, int retry_after_seconds);
+
+		int GetMaxRetries(const std::string& host);
+
+		/**
+		 * \brief Counts one logical request, however many attempts it takes
+		 */
+		void CountRequest(const std::string& host);
+
+		void CountRetry(const std::string& host);
+
+		/**
+		 * \brief Records the size of a response body as received and, if it was compressed, after decoding
+		 * \param decoded_bytes 0 if the body was not compressed
+		 */
+		void RecordTransfer(const std::string& host, size_t wire_bytes, size_t decoded_bytes);
+
+		/**
+		 * \brief One human readable line per known host
+		 */
+		std::vector<std::string> DescribeHosts();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		enum class CircuitState
+		{
+			Closed,
+			Open,
+			HalfOpen
+		};
+
+		struct HostState
+		{
+			HostPolicy policy;
+			double tokens{0.0};
+			Clock::time_point last_refill{};
+			CircuitState circuit{CircuitState::Closed};
+			int consecutive_failures{0};
+			Clock::time_point open_until{};
+			bool probe_in_flight{false};
+			HostStats stats;
+		};
+
+		static HostPolicy ParsePolicy(const nlohmann::json& json, const HostPolicy& defaults);
+
+		HostState& GetState(const std::string& host);
+
+		std::mutex mutex_;
+		bool enabled_{true};
+		HostPolicy default_policy_;
+		std::unordered_map<std::string, HostPolicy> host_policies_;
+		std::unordered_map<std::string, HostState> hosts_;
+	};
+} // namespace API
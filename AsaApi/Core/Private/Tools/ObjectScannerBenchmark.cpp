@@ -0,0 +1,147 @@
+#ifdef ASAAPI_DEV_COMMANDS
+
+#include "ObjectScannerBenchmark.h"
+
+#include "../Ark/ObjectScanner.h"
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <thread>
+
+namespace API
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr int ClassCount = 4000;
+
+		// Only the fields the scanner reads, at offsets of our own
+		struct SyntheticObject
+		{
+			void* vtable{nullptr};
+			int flags{0};
+			int index{0};
+			const SyntheticObject* object_class{nullptr};
+			const SyntheticObject* super{nullptr};
+		};
+
+		struct SyntheticTable
+		{
+			std::vector<SyntheticObject> objects;
+			std::vector<std::unique_ptr<FUObjectItem[]>> chunks;
+			std::vector<FUObjectItem*> chunk_pointers;
+			FChunkedFixedUObjectArray array{};
+		};
+
+		std::unique_ptr<SyntheticTable> MakeTable(int object_count)
+		{
+			constexpr int ElementsPerChunk = FChunkedFixedUObjectArray::ElementsPerChunk;
+
+			auto table = std::make_unique<SyntheticTable>();
+			table->objects.resize(static_cast<size_t>(ClassCount) + object_count);
+
+			std::mt19937 random(42);
+
+			// Classes come first like the native classes do, each derives from a random earlier one
+			for (int i = 0; i < ClassCount; ++i)
+			{
+				SyntheticObject& the_class = table->objects[i];
+				the_class.index = i;
+				the_class.object_class = &table->objects[0];
+				the_class.super = i > 0 ? &table->objects[std::uniform_int_distribution<int>(0, i - 1)(random)] : nullptr;
+			}
+
+			std::uniform_int_distribution<int> random_class(1, ClassCount - 1);
+			for (size_t i = ClassCount; i < table->objects.size(); ++i)
+			{
+				table->objects[i].index = static_cast<int>(i);
+				table->objects[i].object_class = &table->objects[random_class(random)];
+			}
+
+			const int total = static_cast<int>(table->objects.size());
+			const int chunk_count = (total + ElementsPerChunk - 1) / ElementsPerChunk;
+			for (int chunk = 0; chunk < chunk_count; ++chunk)
+			{
+				auto items = std::make_unique<FUObjectItem[]>(ElementsPerChunk);
+				for (int i = 0; i < ElementsPerChunk && chunk * ElementsPerChunk + i < total; ++i)
+					items[i].Object = reinterpret_cast<UObject*>(&table->objects[static_cast<size_t>(chunk) * ElementsPerChunk + i]);
+
+				table->chunk_pointers.push_back(items.get());
+				table->chunks.push_back(std::move(items));
+			}
+
+			table->array.Objects = table->chunk_pointers.data();
+			table->array.NumElements = total;
+			table->array.MaxElements = chunk_count * ElementsPerChunk;
+			table->array.NumChunks = chunk_count;
+			table->array.MaxChunks = chunk_count;
+
+			return table;
+		}
+
+		double ElapsedMs(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+	} // namespace
+
+	std::vector<std::string> RunObjectScannerBenchmark(int object_count)
+	{
+		const auto table = MakeTable(object_count);
+
+		const AsaApi::ObjectScanner::Layout layout{
+			offsetof(SyntheticObject, object_class),
+			offsetof(SyntheticObject, index),
+			offsetof(SyntheticObject, super)
+		};
+
+		// A class near the top of the hierarchy, a good share of the objects derive from it
+		const SyntheticObject* searched = &table->objects[ClassCount / 64];
+		UClass* searched_class = reinterpret_cast<UClass*>(const_cast<SyntheticObject*>(searched));
+
+		auto start = Clock::now();
+		size_t baseline_found = 0;
+		for (size_t i = ClassCount; i < table->objects.size(); ++i)
+		{
+			for (const SyntheticObject* the_class = table->objects[i].object_class; the_class; the_class = the_class->super)
+			{
+				if (the_class == searched)
+				{
+					++baseline_found;
+					break;
+				}
+			}
+		}
+		const double baseline_ms = ElapsedMs(start);
+
+		TArray<UObject*> found;
+
+		start = Clock::now();
+		AsaApi::ObjectScanner::Scan(table->array, layout, searched_class, true, found, 1);
+		const double single_ms = ElapsedMs(start);
+		const int single_found = found.Num();
+
+		const unsigned threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+		start = Clock::now();
+		AsaApi::ObjectScanner::Scan(table->array, layout, searched_class, true, found, threads);
+		const double parallel_ms = ElapsedMs(start);
+
+		std::vector<std::string> report;
+		report.push_back(fmt::format("{} objects, {} classes, {} matches", table->objects.size(), ClassCount, found.Num()));
+		report.push_back(fmt::format("Superclass walk per object: {:.2f} ms", baseline_ms));
+		report.push_back(fmt::format("Scanner, 1 thread: {:.2f} ms", single_ms));
+		report.push_back(fmt::format("Scanner, parallel ({} threads): {:.2f} ms", threads, parallel_ms));
+
+		if (static_cast<size_t>(single_found) != baseline_found || static_cast<size_t>(found.Num()) != baseline_found)
+			report.push_back(fmt::format("Scanner found {}/{} objects, the baseline {}, please report this", single_found, found.Num(), baseline_found));
+
+		return report;
+	}
+} // namespace API
+
+#endif
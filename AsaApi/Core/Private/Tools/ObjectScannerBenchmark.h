@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Times the object scanner on a synthetic object table, the game's objects are not touched.
+	 *
+	 * The table mimics GUObjectArray: 64K element chunks, a few thousand classes with random superclasses and
+	 * `object_count` objects of random classes. The baseline walks the superclass chain of every object.
+	 * \return Report lines
+	 */
+	std::vector<std::string> RunObjectScannerBenchmark(int object_count);
+} // namespace API
@@ -4,21 +4,30 @@
 #pragma warning(disable : 4996)
 
 #include <Requests.h>
+#include <ConfigService.h>
 #include "../IBaseApi.h"
 #include "../Ark/ArkBaseApi.h"
+#include "Compression.h"
+#include "FileDownloader.h"
+#include "HostTrafficShaper.h"
+#include "../PluginManager/PluginProfiler.h"
 
+#include <algorithm>
 #include <atomic>
 #include <fstream>
 #include <intrin.h>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <variant>
 
 #include "json.hpp"
 
 #include "Poco/StreamCopier.h"
+#include "Poco/String.h"
 #include "Poco/URI.h"
 #include "Poco/Exception.h"
 #include "Poco/SharedPtr.h"
@@ -62,6 +71,18 @@ namespace API
 			return callback3Args;
 		}		
 
+		// Value advertised when the caller did not send its own Accept-Encoding header
+		constexpr const char* TransparentEncodings = "gzip, deflate";
+
+		bool HasHeader(const std::vector<std::string>& headers, const std::string& name)
+		{
+			return std::any_of(headers.begin(), headers.end(), [&name](const std::string& header) {
+				std::string key = header.substr(0, header.find(":"));
+				Poco::trimInPlace(key);
+				return Poco::icompare(key, name) == 0;
+			});
+		}
+
 		using CallbackVariant = std::variant<std::function<void(bool, std::string)>, std::function<void(bool, std::string, std::unordered_map<std::string, std::string>)>>;
 	}  // namespace
 	
@@ -80,8 +101,17 @@ namespace API
     	bool LaunchDelete(const std::string &url, const std::function<void(bool, std::string)> &callback, std::vector<std::string> headers, long connectionTimeout, long receiveTimeout, long sendTimeout, bool suppressErrors, HMODULE pluginModule);
 		
 		Poco::Net::HTTPRequest ConstructRequest(const std::string& url, Poco::Net::HTTPClientSession*& session, const std::vector<std::string>& headers, const std::string& request_type, long connectionTimeout, long receiveTimeout, long sendTimeout);
-		std::string GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response); std::unordered_map<std::string, std::string> GetResponseHeaders(Poco::Net::HTTPResponse& response);
+		std::string GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response, const std::vector<std::string>& headers);
+		std::unordered_map<std::string, std::string> GetResponseHeaders(Poco::Net::HTTPResponse& response);
 		void LogRequestError(const std::string& url, const Poco::Exception& exc);
+
+		// Runs a request through the per-host traffic policy. `attempt` performs a single exchange,
+		// the session it creates is released here after every attempt. `response` is constructed anew before
+		// every attempt. Without `mayBlock` (game thread) the request is neither queued nor retried.
+		std::string Execute(const std::string& url, const std::string& method, bool suppressErrors, bool mayBlock,
+			Poco::Net::HTTPResponse& response, const std::function<std::string(Poco::Net::HTTPClientSession*&)>& attempt);
+
+		HostTrafficShaper& GetTrafficShaper() { return TrafficShaper_; }
 			
 		void Update();
 		private:
@@ -103,6 +133,7 @@ namespace API
 		std::mutex RequestMutex_;
 		std::mutex CallbackMutex_;
     	std::atomic<uint64_t> NextId_{1}; // 0 is an internal sentinel
+		HostTrafficShaper TrafficShaper_;
 	};
 
 	// --- PIMPL ---
@@ -110,8 +141,10 @@ namespace API
 	Requests::Requests()
 		: pimpl{ std::make_unique<impl>() }
 	{
-		const nlohmann::json config = dynamic_cast<ArkBaseApi&>(*game_api).GetConfig();
-		suppress_errors = config.value("SuppressHttpErrors", false);
+		const auto config = ConfigService::Get().GetConfig();
+		const nlohmann::json& settings = ConfigService::GetSettings(config);
+		suppress_errors = settings.value("SuppressHttpErrors", config->is_object() && config->value("SuppressHttpErrors", false));
+		pimpl->GetTrafficShaper().Configure(settings);
 
 		Poco::Net::initializeSSL();
 		Poco::SharedPtr<Poco::Net::InvalidCertificateHandler> ptrCert = new Poco::Net::RejectCertificateHandler(false);
@@ -147,7 +180,100 @@ namespace API
 			host = "<unknown host>";
 		}
 
-		Log::GetLog()->error("HTTP request to '{}' failed: {}", host, exc.displayText());
+		// An unreachable host fails every request sent to it, one line per request would bury everything else
+		LOG_LIMITED_KEYED(Log::GetLog(), spdlog::level::err, host, "HTTP request to '{}' failed: {}", host, exc.displayText());
+	}
+
+	std::string Requests::impl::Execute(const std::string& url, const std::string& method, bool suppressErrors, bool mayBlock,
+		Poco::Net::HTTPResponse& response, const std::function<std::string(Poco::Net::HTTPClientSession*&)>& attempt)
+	{
+		std::string host;
+		try
+		{
+			host = Poco::URI(url).getHost();
+		}
+		catch (...)
+		{
+			host = "<unknown host>";
+		}
+
+		// Only methods that are safe to repeat are retried
+		const bool idempotent = method == Poco::Net::HTTPRequest::HTTP_GET
+			|| method == Poco::Net::HTTPRequest::HTTP_HEAD
+			|| method == Poco::Net::HTTPRequest::HTTP_PUT
+			|| method == Poco::Net::HTTPRequest::HTTP_DELETE
+			|| method == Poco::Net::HTTPRequest::HTTP_OPTIONS;
+		const int maxRetries = idempotent && mayBlock ? TrafficShaper_.GetMaxRetries(host) : 0;
+
+		TrafficShaper_.CountRequest(host);
+
+		std::string result;
+		for (int attemptIndex = 0;; ++attemptIndex)
+		{
+			// Headers like Retry-After or Content-Encoding of a failed attempt must not leak into the next one
+			if (attemptIndex > 0)
+			{
+				std::destroy_at(&response);
+				std::construct_at(&response, Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+			}
+
+			switch (TrafficShaper_.Acquire(host, mayBlock))
+			{
+			case HostTrafficShaper::Admission::RateLimited:
+				response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+				return "429 Rate limited by local traffic policy";
+			case HostTrafficShaper::Admission::CircuitOpen:
+				response.setStatusAndReason(Poco::Net::HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+				return "503 Circuit open for host " + host;
+			default:
+				break;
+			}
+
+			Poco::Net::HTTPClientSession* session = nullptr;
+			bool transportError = false;
+
+			try
+			{
+				result = attempt(session);
+			}
+			catch (const Poco::Exception& exc)
+			{
+				// The status line may already have been read when the body failed
+				response.setStatus(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+				transportError = true;
+				result = "";
+
+				if (!suppressErrors && attemptIndex >= maxRetries)
+					LogRequestError(url, exc);
+			}
+
+			delete session;
+			session = nullptr;
+
+			const int status = (int)response.getStatus();
+			const bool retryableStatus = status == 429 || status == 502 || status == 503 || status == 504;
+
+			TrafficShaper_.ReportResult(host, !transportError && status < 500 && status != 429);
+
+			if ((!transportError && !retryableStatus) || attemptIndex >= maxRetries)
+				return result;
+
+			int retryAfter = 0;
+			if (!transportError && response.has("Retry-After"))
+			{
+				try
+				{
+					retryAfter = std::stoi(response.get("Retry-After"));
+				}
+				catch (...)
+				{
+					// HTTP-date form is not supported, fall back to exponential backoff
+				}
+			}
+
+			TrafficShaper_.CountRetry(host);
+			std::this_thread::sleep_for(TrafficShaper_.GetBackoff(host, attemptIndex + 1, retryAfter));
+		}
 	}
 
 	Poco::Net::HTTPRequest Requests::impl::ConstructRequest(const std::string& url, Poco::Net::HTTPClientSession*& session,
@@ -182,10 +308,14 @@ namespace API
 			}
 		}
 
+		if (!HasHeader(headers, "Accept-Encoding"))
+			request.set("Accept-Encoding", TransparentEncodings);
+
 		return request;
 	}
 
-	std::string Requests::impl::GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response)
+	std::string Requests::impl::GetResponse(Poco::Net::HTTPClientSession* session, Poco::Net::HTTPResponse& response,
+		const std::vector<std::string>& headers)
 	{
 		std::string result = "";
 		std::istream& rs = session->receiveResponse(response);
@@ -195,6 +325,27 @@ namespace API
 			std::ostringstream oss;
 			Poco::StreamCopier::copyStream(rs, oss);
 			result = oss.str();
+
+			const size_t wireBytes = result.size();
+			size_t decodedBytes = 0;
+
+			// Bodies are only decoded when the encoding was negotiated by ConstructRequest,
+			// callers sending their own Accept-Encoding get the body as it was sent
+			const std::string encoding = Poco::toLower(Poco::trim(response.get("Content-Encoding", "")));
+			if (!HasHeader(headers, "Accept-Encoding") && (encoding == "gzip" || encoding == "x-gzip" || encoding == "deflate"))
+			{
+				std::string decoded, error;
+				if (!Compression::Inflate(result, decoded, error))
+					throw Poco::DataFormatException(fmt::format("Failed to decode {} response body", encoding), error);
+
+				result = std::move(decoded);
+				decodedBytes = result.size();
+
+				response.erase("Content-Encoding");
+				response.setContentLength64(static_cast<Poco::Int64>(decodedBytes));
+			}
+
+			TrafficShaper_.RecordTransfer(session->getHost(), wireBytes, decodedBytes);
 		}
 		else
 		{
@@ -255,6 +406,11 @@ namespace API
 	    pimpl->UnregisterCallbacksForModule(pluginModule);
 	}
 
+	std::vector<std::string> Requests::GetHostStatistics()
+	{
+		return pimpl->GetTrafficShaper().DescribeHosts();
+	}
+
     // --- GET REQUESTS ---
 
     bool Requests::impl::LaunchGet(const std::string& url, const std::function<void(bool, std::string)>& callback, std::vector<std::string> headers, long connectionTimeout, long receiveTimeout, long sendTimeout, bool suppressErrors, HMODULE pluginModule)
@@ -262,25 +418,19 @@ namespace API
 		const uint64_t callbackId = RegisterCallback(callback, pluginModule);
 
     	std::thread([this, url, headers, connectionTimeout, receiveTimeout, sendTimeout, suppressErrors, callbackId] {
-    	    std::string Result = "";
     	    Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-    	    Poco::Net::HTTPClientSession *session = nullptr;
 
-    	    try {
+    	    std::string Result = Execute(url, Poco::Net::HTTPRequest::HTTP_GET, suppressErrors, true, response, [&](Poco::Net::HTTPClientSession *&session) {
     	        Poco::Net::HTTPRequest &&request =
     	            ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_GET, 	connectionTimeout, receiveTimeout, sendTimeout);
 
     	        session->sendRequest(request);
-    	        Result = GetResponse(session, response);
-    	    } catch (const Poco::Exception &exc) {
-    	        if (!suppressErrors) LogRequestError(url, exc);
-    	    }
+    	        return GetResponse(session, response, headers);
+    	    });
 
     	    const bool success = (int)response.getStatus() >= 200 && (int)response.getStatus() < 300;
 
     	    EnqueueResult(std::move(Result), callbackId, success);
-    	    delete session;
-    	    session = nullptr;
     	}).detach();
 
 		return true;
@@ -321,28 +471,19 @@ namespace API
 	{
 		Requests::RequestSyncData Result;
 		Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-		Poco::Net::HTTPClientSession* session = nullptr;
 
-		try
-		{
-			Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_GET, connectionTimeout, receiveTimeout, sendTimeout);
+		Result.result = pimpl->Execute(url, Poco::Net::HTTPRequest::HTTP_GET, suppress_errors, false, response, [&](Poco::Net::HTTPClientSession*& session)
+			{
+				Poco::Net::HTTPRequest&& request = pimpl->ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_GET, connectionTimeout, receiveTimeout, sendTimeout);
 
-			session->sendRequest(request);
-			Result.result = pimpl->GetResponse(session, response);
-		}
-		catch (const Poco::Exception& exc)
-		{
-			if (!suppress_errors)
-				pimpl->LogRequestError(url, exc);
-		}
+				session->sendRequest(request);
+				return pimpl->GetResponse(session, response, headers);
+			});
 
 		Result.statusCode = (int)response.getStatus();
 		Result.success = (int)response.getStatus() >= 200
 			&& (int)response.getStatus() < 300;
 
-		delete session;
-		session = nullptr;
-
 		return Result;
 	}
 
@@ -354,12 +495,10 @@ namespace API
 
     	std::thread(
     	    [this, url, post_data, content_type, headers, connectionTimeout, receiveTimeout, sendTimeout, 	suppressErrors, callbackId] {
-    	    std::string Result = "";
     	    std::unordered_map<std::string, std::string> responseHeaders;
     	    Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-    	    Poco::Net::HTTPClientSession *session = nullptr;
 
-    		try {
+    		std::string Result = Execute(url, Poco::Net::HTTPRequest::HTTP_POST, suppressErrors, true, response, [&](Poco::Net::HTTPClientSession *&session) {
     		    Poco::Net::HTTPRequest &&request =
     		        ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_POST, 	connectionTimeout, receiveTimeout, sendTimeout);
 					
@@ -369,17 +508,14 @@ namespace API
     		    std::ostream & OutputStream = session->sendRequest(request);
     		    OutputStream << post_data;
 					
-    		    Result          = GetResponse(session, response);
-    		    responseHeaders = GetResponseHeaders(response);
-    		} catch (const Poco::Exception &exc) {
-    		    if (!suppressErrors) LogRequestError(url, exc);
-    		}
+    		    std::string body = GetResponse(session, response, headers);
+    		    responseHeaders  = GetResponseHeaders(response);
+    		    return body;
+    		});
 		
     		const bool success = (int)response.getStatus() >= 200 && (int)response.getStatus() < 300;
 		
     		EnqueueResult(std::move(Result), std::move(responseHeaders), callbackId, success);
-    		delete session;
-    		session = nullptr;
     	}).detach();
 
 		return true;
@@ -390,12 +526,10 @@ namespace API
 		const uint64_t callbackId = RegisterCallback(callback, pluginModule);
 
 		std::thread([this, url, post_ids, post_data, headers, connectionTimeout, receiveTimeout, sendTimeout, suppressErrors, callbackId] {
-				std::string Result = "";
 				std::unordered_map<std::string, std::string> responseHeaders;
 				Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-				Poco::Net::HTTPClientSession* session = nullptr;
 
-				try
+				std::string Result = Execute(url, Poco::Net::HTTPRequest::HTTP_POST, suppressErrors, true, response, [&](Poco::Net::HTTPClientSession*& session)
 				{
 					Poco::Net::HTTPRequest&& request = ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_POST, connectionTimeout, receiveTimeout, sendTimeout);
 
@@ -419,21 +553,15 @@ namespace API
 					std::ostream& OutputStream = session->sendRequest(request);
 					OutputStream << body;
 
-					Result = GetResponse(session, response);
+					std::string result = GetResponse(session, response, headers);
 					responseHeaders = GetResponseHeaders(response);
-				}
-				catch (const Poco::Exception& exc)
-				{
-					if (!suppressErrors)
-						LogRequestError(url, exc);
-				}
+					return result;
+				});
 
 				const bool success = (int)response.getStatus() >= 200
 					&& (int)response.getStatus() < 300;
 
 				EnqueueResult(std::move(Result), std::move(responseHeaders), callbackId, success);
-				delete session;
-				session = nullptr;
 			}
 		).detach();
 
@@ -530,11 +658,9 @@ namespace API
 		const uint64_t callbackId = RegisterCallback(callback, pluginModule);
 
 	    std::thread([this, url, patch_data, content_type, headers, connectionTimeout, receiveTimeout, sendTimeout, suppressErrors, callbackId] {
-	        std::string Result = "";
 	        Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-	        Poco::Net::HTTPClientSession *session = nullptr;
 
-	        try {
+	        std::string Result = Execute(url, Poco::Net::HTTPRequest::HTTP_PATCH, suppressErrors, true, response, [&](Poco::Net::HTTPClientSession *&session) {
 	            Poco::Net::HTTPRequest &&request =
 	                ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_PATCH, 	connectionTimeout,
 	                                        receiveTimeout, sendTimeout);
@@ -545,16 +671,12 @@ namespace API
 	            std::ostream &OutputStream = session->sendRequest(request);
 	            OutputStream << patch_data;
 
-	            Result = GetResponse(session, response);
-	        } catch (const Poco::Exception &exc) {
-	            if (!suppressErrors) LogRequestError(url, exc);
-	        }
+	            return GetResponse(session, response, headers);
+	        });
 
 	        const bool success = (int)response.getStatus() >= 200 && (int)response.getStatus() < 300;
 
 	        EnqueueResult(std::move(Result), callbackId, success);
-	        delete session;
-	        session = nullptr;
 	    }).detach();
 
 		return true;
@@ -611,25 +733,19 @@ namespace API
 		const uint64_t callbackId = RegisterCallback(callback, pluginModule);
 
 	    std::thread([this, url, headers, connectionTimeout, receiveTimeout, sendTimeout, suppressErrors, callbackId] {
-	        std::string Result = "";
 	        Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-	        Poco::Net::HTTPClientSession *session = nullptr;
 
-	        try {
+	        std::string Result = Execute(url, Poco::Net::HTTPRequest::HTTP_DELETE, suppressErrors, true, response, [&](Poco::Net::HTTPClientSession *&session) {
 	            Poco::Net::HTTPRequest &&request =
 	                ConstructRequest(url, session, headers, Poco::Net::HTTPRequest::HTTP_DELETE, connectionTimeout, receiveTimeout, sendTimeout);
 
 	            session->sendRequest(request);
-	            Result = GetResponse(session, response);
-	        } catch (const Poco::Exception &exc) {
-	            if (!suppressErrors) LogRequestError(url, exc);
-	        }
+	            return GetResponse(session, response, headers);
+	        });
 
 	        const bool success = (int)response.getStatus() >= 200 && (int)response.getStatus() < 300;
 
 	        EnqueueResult(std::move(Result), callbackId, success);
-	        delete session;
-	        session = nullptr;
 	    }).detach();		
 
 		return true;
@@ -751,68 +867,29 @@ namespace API
 
 	bool Requests::DownloadFile(const std::string& url, const std::string& localPath, std::vector<std::string> headers)
 	{
-		Poco::Net::HTTPResponse response(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
-		Poco::Net::HTTPClientSession* session = nullptr;
+		return DownloadFile(url, localPath, std::move(headers), "");
+	}
 
+	bool Requests::DownloadFile(const std::string& url, const std::string& localPath, std::vector<std::string> headers,
+		const std::string& expectedSha256, int maxSegments)
+	{
 		try
 		{
+			// May run before the Requests singleton exists, e.g. for the cache download during startup
 			Poco::Net::initializeSSL();
 			Poco::SharedPtr<Poco::Net::InvalidCertificateHandler> ptrCert = new Poco::Net::RejectCertificateHandler(false);
 
 			Poco::Net::Context::Ptr ptrContext = new Poco::Net::Context(Poco::Net::Context::TLS_CLIENT_USE, "", "", "", Poco::Net::Context::VERIFY_NONE, 9, false, "ALL:!ADH:!LOW:!EXP:!MD5:@STRENGTH");
 
 			Poco::Net::SSLManager::instance().initializeClient(0, ptrCert, ptrContext);
-
-			Poco::URI uri(url);
-
-			const std::string& path(uri.getPathAndQuery());
-
-			if (uri.getScheme() == "https")
-				session = new Poco::Net::HTTPSClientSession(uri.getHost(), uri.getPort());
-			else
-				session = new Poco::Net::HTTPClientSession(uri.getHost(), uri.getPort());
-
-			Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_GET, path, Poco::Net::HTTPMessage::HTTP_1_1);
-
-			session->sendRequest(request);
-			std::istream& rs = session->receiveResponse(response);
-			if (response.getStatus() == Poco::Net::HTTPResponse::HTTP_OK)
-			{
-				std::ofstream outFile(localPath, std::ios::binary);
-				if (!outFile)
-				{
-					Log::GetLog()->error("Writing the file '{}' failed", localPath);
-					delete session;
-					session = nullptr;
-					return false;
-				}
-
-				Poco::StreamCopier::copyStream(rs, outFile);
-			}
-			else
-			{
-				Poco::NullOutputStream null;
-				Poco::StreamCopier::copyStream(rs, null);
-				delete session;
-				session = nullptr;
-				return false;
-			}
 		}
 		catch (const Poco::Exception& exc)
 		{
-			std::string host;
-			try { host = Poco::URI(url).getHost(); }
-			catch (...) { host = "<unknown host>"; }
-			Log::GetLog()->error("HTTP request to '{}' failed: {}", host, exc.displayText());
-
-			delete session;
-			session = nullptr;
+			Log::GetLog()->error("({}) {}", __FUNCTION__, exc.displayText());
 			return false;
 		}
 
-		delete session;
-		session = nullptr;
-		return true;
+		return FileDownloader(url, localPath, std::move(headers)).Run(expectedSha256, maxSegments);
 	}
 
 	void Requests::impl::Update() {
@@ -832,6 +909,7 @@ namespace API
 			}
 			
 			CallbackVariant callback;
+			HMODULE pluginModule = nullptr;
 			{
 				std::lock_guard<std::mutex> lock(CallbackMutex_);
 				auto it = CallbacksMap_.find(request.callbackId);
@@ -842,11 +920,13 @@ namespace API
 				}
 			
 				callback = std::move(it->second.callback);
+				pluginModule = it->second.pluginModule;
 				CallbacksMap_.erase(it);
 			}
 			
 			// Safe to invoke unlocked: `PluginManager::UnloadPlugin` runs on the game thread, same as Update().
 			// Caveat: self-unload from inside a callback is unsupported.
+			PluginProfiler::Scope scope(pluginModule, PluginProfiler::Category::Request);
 			std::visit([&](auto&& cb) {
 				using T = std::decay_t<decltype(cb)>;
 				
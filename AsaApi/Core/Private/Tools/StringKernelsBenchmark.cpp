@@ -0,0 +1,146 @@
+#ifdef ASAAPI_DEV_COMMANDS
+
+#include "StringKernelsBenchmark.h"
+
+#include <API/ARK/Ark.h>
+#include <API/Helpers/StringKernels.h>
+#include <Logger/Logger.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace API
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		std::vector<FString> MakeSamples()
+		{
+			std::vector<FString> samples;
+
+			for (int i = 0; i < 64; ++i)
+			{
+				samples.push_back(FString::Format("0002{:028x}", 0x9E3779B97F4A7C15ull * (i + 1)));
+				samples.push_back(FString::Format("Survivor{}", i));
+				samples.push_back(FString::Format("/shop{}", i % 8));
+				samples.push_back(FString::Format(
+					"Blueprint'/Game/PrimalEarth/CoreBlueprints/Items/Resources/PrimalItemResource_Benchmark{}.PrimalItemResource_Benchmark{}'",
+					i, i));
+			}
+
+			return samples;
+		}
+
+		// Same strings with every ASCII letter flipped, the case insensitive paths must match all of them
+		std::vector<FString> FlipCase(const std::vector<FString>& samples)
+		{
+			std::vector<FString> flipped;
+			flipped.reserve(samples.size());
+
+			for (const FString& sample : samples)
+			{
+				FString copy = sample;
+				for (int i = 0; i < copy.Len(); ++i)
+				{
+					TCHAR& c = copy[i];
+					if ((c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z'))
+						c ^= 0x20;
+				}
+
+				flipped.push_back(copy);
+			}
+
+			return flipped;
+		}
+
+		template <typename Func>
+		double MeasureNs(int rounds, size_t operations, Func&& func)
+		{
+			const auto start = Clock::now();
+			for (int round = 0; round < rounds; ++round)
+				func();
+
+			const double elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+			return elapsed_ns / (static_cast<double>(rounds) * static_cast<double>(operations));
+		}
+
+		std::string Line(const char* operation, double baseline_ns, double kernel_ns)
+		{
+			return fmt::format("{}: {:.1f} ns -> {:.1f} ns ({:.1f}x)", operation, baseline_ns, kernel_ns,
+				kernel_ns > 0.0 ? baseline_ns / kernel_ns : 0.0);
+		}
+	} // namespace
+
+	std::vector<std::string> RunStringKernelsBenchmark(int rounds)
+	{
+		const std::vector<FString> samples = MakeSamples();
+		const std::vector<FString> copies = samples;
+		const std::vector<FString> flipped = FlipCase(samples);
+		const size_t count = samples.size();
+
+		// Keeps the results alive so the measured calls are not optimized out
+		volatile uint64_t sink = 0;
+
+		const double utf8_hash = MeasureNs(rounds, count, [&] {
+			for (const FString& sample : samples)
+				sink = sink + std::hash<std::string>{}(std::string(TCHAR_TO_UTF8(*sample)));
+		});
+		const double kernel_hash = MeasureNs(rounds, count, [&] {
+			for (const FString& sample : samples)
+				sink = sink + AsaApi::StringKernels::Hash(*sample, sample.Len());
+		});
+
+		const double lower_hash = MeasureNs(rounds, count, [&] {
+			for (const FString& sample : samples)
+				sink = sink + std::hash<std::string>{}(std::string(TCHAR_TO_UTF8(*sample.ToLower())));
+		});
+		const double kernel_hash_ignore_case = MeasureNs(rounds, count, [&] {
+			for (const FString& sample : samples)
+				sink = sink + AsaApi::StringKernels::HashIgnoreCase(*sample, sample.Len());
+		});
+
+		const double fstring_equals = MeasureNs(rounds, count, [&] {
+			for (size_t i = 0; i < count; ++i)
+				sink = sink + samples[i].Equals(samples[(i + 1) % count]) + samples[i].Equals(copies[i]);
+		});
+		const double kernel_equals = MeasureNs(rounds, count, [&] {
+			FStringEqual equal;
+			for (size_t i = 0; i < count; ++i)
+				sink = sink + equal(samples[i], samples[(i + 1) % count]) + equal(samples[i], copies[i]);
+		});
+
+		const double fstring_compare = MeasureNs(rounds, count, [&] {
+			for (size_t i = 0; i < count; ++i)
+				sink = sink + (samples[i].Compare(flipped[i], ESearchCase::IgnoreCase) == 0);
+		});
+		const double kernel_compare = MeasureNs(rounds, count, [&] {
+			FStringEqualIgnoreCase equal;
+			for (size_t i = 0; i < count; ++i)
+				sink = sink + equal(samples[i], flipped[i]);
+		});
+
+		bool consistent = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			consistent &= FStringEqualIgnoreCase{}(samples[i], flipped[i])
+				&& FStringHashIgnoreCase{}(samples[i]) == FStringHashIgnoreCase{}(flipped[i]);
+		}
+
+		std::vector<std::string> report;
+		report.push_back(fmt::format("{} strings x {} rounds, AVX2 {}", count, rounds,
+			AsaApi::StringKernels::Detail::HasAvx2() ? "on" : "off"));
+		report.push_back(Line("hash (utf8 std::hash -> kernel)", utf8_hash, kernel_hash));
+		report.push_back(Line("hash ignore case (ToLower + utf8 -> kernel)", lower_hash, kernel_hash_ignore_case));
+		report.push_back(Line("equals (FString::Equals -> FStringEqual)", fstring_equals, kernel_equals));
+		report.push_back(Line("equals ignore case (Compare -> FStringEqualIgnoreCase)", fstring_compare, kernel_compare));
+
+		if (!consistent)
+			report.push_back("Case insensitive kernels disagree with FString, please report this");
+
+		return report;
+	}
+} // namespace API
+
+#endif
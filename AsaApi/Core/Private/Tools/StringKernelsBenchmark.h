@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace API
+{
+	/**
+	 * \brief Times the string kernels against the FString paths they replace.
+	 *
+	 * Runs synchronously on the calling thread over a fixed set of EOS ids, names, commands and blueprint paths.
+	 * \param rounds Number of passes over the set
+	 * \return Report lines, one per measured operation
+	 */
+	std::vector<std::string> RunStringKernelsBenchmark(int rounds);
+} // namespace API
@@ -1,11 +1,21 @@
 #include "Timer.h"
 
 #include "../IBaseApi.h"
+#include "../PluginManager/PluginProfiler.h"
 
 #include <Timer.h>
 
 namespace API
 {
+	namespace
+	{
+		// Timers only know the path of their plugin, the handle is what the profiler keys on
+		HMODULE GetTimerModule(const FString& moduleName)
+		{
+			return moduleName.IsEmpty() ? nullptr : GetModuleHandleW(*moduleName);
+		}
+	} // namespace
+
 	Timer::Timer()
 	{
 		game_api->GetCommands()->AddOnTimerCallback("API.TimerUpdate", std::bind(&Timer::Update, this));
@@ -27,7 +37,10 @@ namespace API
 		const auto now = std::chrono::system_clock::now();
 		const auto exec_time = now + std::chrono::seconds(delay_seconds);
 
-		timer_funcs_.emplace_back(std::make_shared<TimerFunc>(exec_time, callback, true, 1, 0, identifier, moduleName));
+		auto timer_func = std::make_shared<TimerFunc>(exec_time, callback, true, 1, 0, identifier, moduleName);
+		timer_func->module = GetTimerModule(moduleName);
+
+		timer_funcs_.push_back(std::move(timer_func));
 	}
 
 	void Timer::RecurringExecuteInternal(const std::function<void()>& callback, int execution_interval,
@@ -56,8 +69,11 @@ namespace API
 		else
 		{
 			const auto now = std::chrono::system_clock::now();
-			timer_funcs_.emplace_back(
-				std::make_shared<TimerFunc>(now, callback, false, execution_counter, execution_interval, identifier, moduleName));
+			auto timer_func = std::make_shared<TimerFunc>(now, callback, false, execution_counter, execution_interval,
+				identifier, moduleName);
+			timer_func->module = GetTimerModule(moduleName);
+
+			timer_funcs_.push_back(std::move(timer_func));
 		}
 	}
 
@@ -115,6 +131,7 @@ namespace API
 					data->next_time = now + std::chrono::seconds(data->execution_interval);
 				}
 
+				PluginProfiler::Scope scope(data->module, PluginProfiler::Category::DelayedTimer);
 				data->callback();
 			}
 		}
@@ -0,0 +1,551 @@
+#define WIN32_LEAN_AND_MEAN
+#pragma warning(push)
+#pragma warning(disable: 4191)
+
+#include <WebSockets.h>
+#include <Requests.h>
+#include "../IBaseApi.h"
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <intrin.h>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "Poco/Buffer.h"
+#include "Poco/Exception.h"
+#include "Poco/URI.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPSClientSession.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/WebSocket.h"
+
+namespace API
+{
+	namespace
+	{
+		constexpr size_t MaxQueuedFrames = 1024;
+		constexpr int MaxPayloadSize = 16 * 1024 * 1024;
+		constexpr long PollIntervalUs = 50 * 1000;
+
+		std::optional<HMODULE> TryGetModuleHandleFromAddress(void* address)
+		{
+			HMODULE HModule = nullptr;
+
+			if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)address, &HModule))
+			{
+				return HModule;
+			}
+
+			return std::nullopt;
+		}
+	} // namespace
+
+	class WebSockets::impl
+	{
+	public:
+		struct Connection
+		{
+			uint64_t id{0};
+			std::string url;
+			ConnectionOptions options;
+			HMODULE pluginModule{nullptr};
+
+			// Only touched on the game thread
+			std::function<void(std::string, bool)> onMessage;
+			std::function<void(bool)> onStateChanged;
+
+			std::atomic<bool> stop{false};
+			std::atomic<bool> connected{false};
+			std::atomic<bool> finished{false};
+
+			std::mutex mutex;
+			std::condition_variable wake;
+			std::deque<std::pair<std::string, bool>> outgoing;
+		};
+
+		uint64_t Open(const std::string& url, const std::function<void(std::string, bool)>& onMessage,
+			const std::function<void(bool)>& onStateChanged, const ConnectionOptions& options, HMODULE pluginModule);
+		std::shared_ptr<Connection> Find(uint64_t connectionId);
+		void Close(uint64_t connectionId);
+		void CloseConnectionsForModule(HMODULE pluginModule);
+		void CloseAll();
+		void JoinWorkers();
+
+		void Update();
+
+	private:
+		enum class EventType
+		{
+			Message,
+			Connected,
+			Disconnected
+		};
+
+		struct Event
+		{
+			uint64_t connectionId;
+			EventType type;
+			std::string payload;
+			bool binary;
+		};
+
+		struct Worker
+		{
+			std::shared_ptr<Connection> connection;
+			std::thread thread;
+		};
+
+		static void Stop(const std::shared_ptr<Connection>& connection);
+
+		// Joins the workers of connections that have ended, those joins do not block
+		void ReapWorkers();
+
+		void Run(std::shared_ptr<Connection> connection);
+		void Serve(Connection& connection, Poco::Net::WebSocket& socket);
+		void PushEvent(uint64_t connectionId, EventType type, std::string payload = {}, bool binary = false);
+
+		std::unordered_map<uint64_t, std::shared_ptr<Connection>> Connections_;
+		std::mutex ConnectionsMutex_;
+		std::vector<Event> Events_;
+		std::mutex EventsMutex_;
+		std::atomic<uint64_t> NextId_{1};
+		std::vector<Worker> Workers_;
+		std::mutex WorkersMutex_;
+	};
+
+	// --- PIMPL ---
+
+	WebSockets::WebSockets()
+		: pimpl{ std::make_unique<impl>() }
+	{
+		// Requests owns the TLS client context used by wss:// connections
+		Requests::Get();
+
+		game_api->GetCommands()->AddOnTickCallback("WebSocketsUpdate", std::bind(&impl::Update, this->pimpl.get()));
+	}
+
+	WebSockets::~WebSockets()
+	{
+		pimpl->CloseAll();
+		pimpl->JoinWorkers();
+		game_api->GetCommands()->RemoveOnTickCallback("WebSocketsUpdate");
+	}
+
+	WebSockets& WebSockets::Get()
+	{
+		static WebSockets instance;
+		return instance;
+	}
+
+	uint64_t WebSockets::Connect(const std::string& url, const std::function<void(std::string, bool)>& onMessage,
+		const std::function<void(bool)>& onStateChanged, const ConnectionOptions& options)
+	{
+		auto HModuleOpt = TryGetModuleHandleFromAddress(_ReturnAddress());
+		if (!HModuleOpt) {
+			Log::GetLog()->error(
+				"Failed to get module handle for caller of WebSockets::Connect. Connection cancelled. Error code: {}", GetLastError());
+			return 0;
+		}
+
+		return pimpl->Open(url, onMessage, onStateChanged, options, *HModuleOpt);
+	}
+
+	bool WebSockets::Send(uint64_t connectionId, const std::string& message, bool binary)
+	{
+		const auto connection = pimpl->Find(connectionId);
+		if (!connection || !connection->connected)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(connection->mutex);
+			if (connection->outgoing.size() >= MaxQueuedFrames)
+				return false;
+
+			connection->outgoing.emplace_back(message, binary);
+		}
+
+		return true;
+	}
+
+	bool WebSockets::IsConnected(uint64_t connectionId)
+	{
+		const auto connection = pimpl->Find(connectionId);
+		return connection && connection->connected;
+	}
+
+	void WebSockets::Close(uint64_t connectionId)
+	{
+		pimpl->Close(connectionId);
+	}
+
+	void WebSockets::CloseConnectionsForModule(HMODULE pluginModule)
+	{
+		pimpl->CloseConnectionsForModule(pluginModule);
+	}
+
+	// --- IMPL ---
+
+	uint64_t WebSockets::impl::Open(const std::string& url, const std::function<void(std::string, bool)>& onMessage,
+		const std::function<void(bool)>& onStateChanged, const ConnectionOptions& options, HMODULE pluginModule)
+	{
+		auto connection = std::make_shared<Connection>();
+		connection->id = NextId_.fetch_add(1);
+		connection->url = url;
+		connection->options = options;
+		connection->pluginModule = pluginModule;
+		connection->onMessage = onMessage;
+		connection->onStateChanged = onStateChanged;
+
+		{
+			std::lock_guard<std::mutex> lock(ConnectionsMutex_);
+			Connections_.emplace(connection->id, connection);
+		}
+
+		ReapWorkers();
+
+		// The worker owns a reference, so closing never has to wait for a blocking connect. Workers are joined
+		// once they have ended and at the latest when the API shuts down, they never outlive this object.
+		{
+			std::lock_guard<std::mutex> lock(WorkersMutex_);
+			Workers_.push_back({connection, std::thread(&impl::Run, this, connection)});
+		}
+
+		return connection->id;
+	}
+
+	std::shared_ptr<WebSockets::impl::Connection> WebSockets::impl::Find(uint64_t connectionId)
+	{
+		std::lock_guard<std::mutex> lock(ConnectionsMutex_);
+		const auto iter = Connections_.find(connectionId);
+		return iter != Connections_.end() ? iter->second : nullptr;
+	}
+
+	void WebSockets::impl::Stop(const std::shared_ptr<Connection>& connection)
+	{
+		{
+			std::lock_guard<std::mutex> lock(connection->mutex);
+			connection->stop = true;
+		}
+
+		connection->wake.notify_all();
+	}
+
+	void WebSockets::impl::Close(uint64_t connectionId)
+	{
+		std::shared_ptr<Connection> connection;
+		{
+			std::lock_guard<std::mutex> lock(ConnectionsMutex_);
+			const auto iter = Connections_.find(connectionId);
+			if (iter == Connections_.end())
+				return;
+
+			connection = iter->second;
+			Connections_.erase(iter);
+		}
+
+		Stop(connection);
+	}
+
+	void WebSockets::impl::CloseConnectionsForModule(HMODULE pluginModule)
+	{
+		std::vector<std::shared_ptr<Connection>> closed;
+		{
+			std::lock_guard<std::mutex> lock(ConnectionsMutex_);
+			for (auto iter = Connections_.begin(); iter != Connections_.end();)
+			{
+				if (iter->second->pluginModule == pluginModule)
+				{
+					closed.push_back(iter->second);
+					iter = Connections_.erase(iter);
+				}
+				else
+				{
+					++iter;
+				}
+			}
+		}
+
+		for (const auto& connection : closed)
+		{
+			Stop(connection);
+		}
+
+		if (!closed.empty())
+			Log::GetLog()->debug("Closed {} WebSocket connections.", closed.size());
+	}
+
+	void WebSockets::impl::CloseAll()
+	{
+		std::unordered_map<uint64_t, std::shared_ptr<Connection>> closed;
+		{
+			std::lock_guard<std::mutex> lock(ConnectionsMutex_);
+			closed.swap(Connections_);
+		}
+
+		for (const auto& [id, connection] : closed)
+		{
+			Stop(connection);
+		}
+	}
+
+	void WebSockets::impl::ReapWorkers()
+	{
+		std::vector<Worker> finished;
+		{
+			std::lock_guard<std::mutex> lock(WorkersMutex_);
+			for (auto iter = Workers_.begin(); iter != Workers_.end();)
+			{
+				if (iter->connection->finished)
+				{
+					finished.push_back(std::move(*iter));
+					iter = Workers_.erase(iter);
+				}
+				else
+				{
+					++iter;
+				}
+			}
+		}
+
+		for (Worker& worker : finished)
+		{
+			worker.thread.join();
+		}
+	}
+
+	void WebSockets::impl::JoinWorkers()
+	{
+		std::vector<Worker> workers;
+		{
+			std::lock_guard<std::mutex> lock(WorkersMutex_);
+			workers.swap(Workers_);
+		}
+
+		// Stopped workers leave within a poll interval, a pending connect within its timeout
+		for (Worker& worker : workers)
+		{
+			worker.thread.join();
+		}
+	}
+
+	void WebSockets::impl::PushEvent(uint64_t connectionId, EventType type, std::string payload, bool binary)
+	{
+		std::lock_guard<std::mutex> lock(EventsMutex_);
+		Events_.push_back({connectionId, type, std::move(payload), binary});
+	}
+
+	void WebSockets::impl::Run(std::shared_ptr<Connection> connection)
+	{
+		const ConnectionOptions& options = connection->options;
+		thread_local std::mt19937 generator{std::random_device{}()};
+		int failures = 0;
+
+		while (!connection->stop)
+		{
+			std::string host = "<unknown host>";
+
+			try
+			{
+				const Poco::URI uri(connection->url);
+				host = uri.getHost();
+
+				const bool secure = uri.getScheme() == "wss" || uri.getScheme() == "https";
+				const Poco::UInt16 port = uri.getPort() != 0 ? uri.getPort() : (secure ? 443 : 80);
+
+				std::unique_ptr<Poco::Net::HTTPClientSession> session;
+				if (secure)
+					session = std::make_unique<Poco::Net::HTTPSClientSession>(uri.getHost(), port);
+				else
+					session = std::make_unique<Poco::Net::HTTPClientSession>(uri.getHost(), port);
+
+				if (options.connectTimeoutSeconds > 0)
+					session->setTimeout(Poco::Timespan(options.connectTimeoutSeconds, 0));
+
+				const std::string path = uri.getPathAndQuery().empty() ? "/" : uri.getPathAndQuery();
+				Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_GET, path, Poco::Net::HTTPMessage::HTTP_1_1);
+
+				for (const auto& header : options.headers)
+				{
+					const std::string& key = header.substr(0, header.find(":"));
+					const std::string& data = header.substr(header.find(":") + 1);
+
+					request.add(key, data);
+				}
+
+				Poco::Net::HTTPResponse response;
+				Poco::Net::WebSocket socket(*session, request, response);
+				socket.setMaxPayloadSize(MaxPayloadSize);
+
+				if (failures > 0)
+					Log::GetLog()->info("WebSocket connection to '{}' re-established after {} attempts", host, failures);
+
+				failures = 0;
+				connection->connected = true;
+				PushEvent(connection->id, EventType::Connected);
+
+				Serve(*connection, socket);
+			}
+			catch (const Poco::Exception& exc)
+			{
+				// Only the first failure of a streak is worth a warning
+				if (failures == 0 && !connection->stop)
+					Log::GetLog()->warn("WebSocket connection to '{}' failed: {}", host, exc.displayText());
+			}
+
+			if (connection->connected.exchange(false))
+				PushEvent(connection->id, EventType::Disconnected);
+
+			{
+				std::lock_guard<std::mutex> lock(connection->mutex);
+				connection->outgoing.clear();
+			}
+
+			if (connection->stop || !options.reconnect)
+				break;
+
+			++failures;
+
+			const int minDelay = (std::max)(1, options.reconnectMinDelayMs);
+			const int ceiling = static_cast<int>((std::min)(static_cast<long long>((std::max)(minDelay, options.reconnectMaxDelayMs)),
+				static_cast<long long>(minDelay) << (std::min)(failures - 1, 20)));
+			std::uniform_int_distribution<int> distribution(ceiling / 2, ceiling);
+
+			std::unique_lock<std::mutex> lock(connection->mutex);
+			connection->wake.wait_for(lock, std::chrono::milliseconds(distribution(generator)), [&connection] {
+				return connection->stop.load();
+			});
+		}
+
+		connection->finished = true;
+	}
+
+	void WebSockets::impl::Serve(Connection& connection, Poco::Net::WebSocket& socket)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const auto pingInterval = std::chrono::seconds(connection.options.pingIntervalSeconds);
+		Clock::time_point lastReceived = Clock::now();
+		Clock::time_point lastPing = lastReceived;
+
+		Poco::Buffer<char> buffer(0);
+		std::string message;
+		bool messageBinary = false;
+
+		// Frames are sent from this thread too, TLS sessions must not be used from two threads at once
+		while (!connection.stop)
+		{
+			std::deque<std::pair<std::string, bool>> outgoing;
+			{
+				std::lock_guard<std::mutex> lock(connection.mutex);
+				outgoing.swap(connection.outgoing);
+			}
+
+			for (const auto& [payload, binary] : outgoing)
+			{
+				socket.sendFrame(payload.data(), static_cast<int>(payload.size()),
+					binary ? Poco::Net::WebSocket::FRAME_BINARY : Poco::Net::WebSocket::FRAME_TEXT);
+			}
+
+			const auto now = Clock::now();
+
+			if (socket.available() <= 0 && !socket.poll(Poco::Timespan(0, PollIntervalUs), Poco::Net::Socket::SELECT_READ))
+			{
+				if (connection.options.pingIntervalSeconds > 0)
+				{
+					if (now - lastReceived > pingInterval * 2)
+						throw Poco::TimeoutException("no frames received within two ping intervals");
+
+					if (now - lastPing > pingInterval)
+					{
+						socket.sendFrame(nullptr, 0, Poco::Net::WebSocket::FRAME_FLAG_FIN | Poco::Net::WebSocket::FRAME_OP_PING);
+						lastPing = now;
+					}
+				}
+
+				continue;
+			}
+
+			int flags = 0;
+			buffer.resize(0);
+			const int received = socket.receiveFrame(buffer, flags);
+			lastReceived = Clock::now();
+
+			// Orderly close of the TCP connection
+			if (received == 0 && flags == 0)
+				return;
+
+			switch (flags & Poco::Net::WebSocket::FRAME_OP_BITMASK)
+			{
+			case Poco::Net::WebSocket::FRAME_OP_CLOSE:
+				socket.shutdown();
+				return;
+			case Poco::Net::WebSocket::FRAME_OP_PING:
+				socket.sendFrame(buffer.begin(), received, Poco::Net::WebSocket::FRAME_FLAG_FIN | Poco::Net::WebSocket::FRAME_OP_PONG);
+				continue;
+			case Poco::Net::WebSocket::FRAME_OP_PONG:
+				continue;
+			case Poco::Net::WebSocket::FRAME_OP_TEXT:
+			case Poco::Net::WebSocket::FRAME_OP_BINARY:
+				messageBinary = (flags & Poco::Net::WebSocket::FRAME_OP_BITMASK) == Poco::Net::WebSocket::FRAME_OP_BINARY;
+				message.assign(buffer.begin(), received);
+				break;
+			case Poco::Net::WebSocket::FRAME_OP_CONT:
+				message.append(buffer.begin(), received);
+				if (message.size() > static_cast<size_t>(MaxPayloadSize))
+					throw Poco::Net::WebSocketException("fragmented message exceeds the payload limit");
+				break;
+			default:
+				continue;
+			}
+
+			if (flags & Poco::Net::WebSocket::FRAME_FLAG_FIN)
+				PushEvent(connection.id, EventType::Message, std::move(message), messageBinary);
+		}
+
+		// Closed by the owner
+		socket.shutdown();
+	}
+
+	void WebSockets::impl::Update()
+	{
+		std::vector<Event> events;
+		{
+			std::lock_guard<std::mutex> lock(EventsMutex_);
+			if (Events_.empty())
+				return;
+
+			events = std::move(Events_);
+		}
+
+		for (auto& event : events)
+		{
+			// Connections closed in the meantime, possibly by an unloaded plugin, get nothing
+			const auto connection = Find(event.connectionId);
+			if (!connection)
+				continue;
+
+			switch (event.type)
+			{
+			case EventType::Message:
+				if (connection->onMessage)
+					connection->onMessage(std::move(event.payload), event.binary);
+				break;
+			case EventType::Connected:
+			case EventType::Disconnected:
+				if (connection->onStateChanged)
+					connection->onStateChanged(event.type == EventType::Connected);
+				break;
+			}
+		}
+	}
+} // namespace API
+
+#pragma warning(pop)
@@ -0,0 +1,266 @@
+#ifdef ASAAPI_DEV_COMMANDS
+
+#define WIN32_LEAN_AND_MEAN
+
+#include "WebSocketsSelfTest.h"
+
+#include <WebSockets.h>
+#include "../IBaseApi.h"
+#include <Logger/Logger.h>
+
+#include <thread>
+
+#include "Poco/Buffer.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/WebSocket.h"
+
+namespace API
+{
+	namespace
+	{
+		constexpr auto SelfTestTimeout = std::chrono::seconds(15);
+
+		// Sent by the client to make the server drop the connection without a close frame
+		const std::string DropCommand = "drop";
+
+		const std::string& GetTextPayload()
+		{
+			static const std::string payload = "{\"event\":\"selftest\",\"name\":\"Survivor\",\"tribe\":1234567890}";
+			return payload;
+		}
+
+		// Large enough to be split into several TCP segments
+		const std::string& GetBinaryPayload()
+		{
+			static const std::string payload = [] {
+				std::string bytes(256 * 1024, '\0');
+				for (size_t i = 0; i < bytes.size(); ++i)
+					bytes[i] = static_cast<char>((i * 131) ^ (i >> 8));
+				return bytes;
+			}();
+
+			return payload;
+		}
+
+		class EchoRequestHandler : public Poco::Net::HTTPRequestHandler
+		{
+		public:
+			void handleRequest(Poco::Net::HTTPServerRequest& request, Poco::Net::HTTPServerResponse& response) override
+			{
+				try
+				{
+					Poco::Net::WebSocket socket(request, response);
+					socket.setMaxPayloadSize(1024 * 1024);
+					socket.setReceiveTimeout(Poco::Timespan(SelfTestTimeout.count(), 0));
+
+					Poco::Buffer<char> buffer(0);
+					for (;;)
+					{
+						int flags = 0;
+						buffer.resize(0);
+						const int received = socket.receiveFrame(buffer, flags);
+
+						const int opcode = flags & Poco::Net::WebSocket::FRAME_OP_BITMASK;
+						if ((received == 0 && flags == 0) || opcode == Poco::Net::WebSocket::FRAME_OP_CLOSE)
+							return;
+
+						if (opcode == Poco::Net::WebSocket::FRAME_OP_TEXT
+							&& std::string(buffer.begin(), received) == DropCommand)
+						{
+							socket.shutdownSend();
+							return;
+						}
+
+						if (opcode == Poco::Net::WebSocket::FRAME_OP_TEXT || opcode == Poco::Net::WebSocket::FRAME_OP_BINARY)
+							socket.sendFrame(buffer.begin(), received, flags);
+					}
+				}
+				catch (const Poco::Exception&)
+				{
+					// The client went away, the test reports what it saw
+				}
+			}
+		};
+
+		class EchoHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory
+		{
+		public:
+			Poco::Net::HTTPRequestHandler* createRequestHandler(const Poco::Net::HTTPServerRequest& /*request*/) override
+			{
+				return new EchoRequestHandler;
+			}
+		};
+	} // namespace
+
+	WebSocketsSelfTest& WebSocketsSelfTest::Get()
+	{
+		static WebSocketsSelfTest instance;
+		return instance;
+	}
+
+	WebSocketsSelfTest::~WebSocketsSelfTest()
+	{
+		if (server_)
+			server_->stopAll(true);
+	}
+
+	std::string WebSocketsSelfTest::Start()
+	{
+		if (running_)
+			return "WebSocket self-test already running";
+
+		Poco::UInt16 port = 0;
+		try
+		{
+			Poco::Net::ServerSocket socket(Poco::Net::SocketAddress("127.0.0.1", 0));
+			port = socket.address().port();
+
+			server_ = std::make_unique<Poco::Net::HTTPServer>(new EchoHandlerFactory, socket, new Poco::Net::HTTPServerParams);
+			server_->start();
+		}
+		catch (const Poco::Exception& exc)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, exc.displayText());
+			server_.reset();
+			return "Failed to start local echo server - " + exc.displayText();
+		}
+
+		++generation_;
+		running_ = true;
+		stage_ = Stage::Connecting;
+		echoes_ = 0;
+		reconnect_ms_ = 0.0;
+		started_at_ = Clock::now();
+
+		game_api->GetCommands()->AddOnTickCallback("WebSocketsSelfTest", [this](float) { Tick(); });
+
+		WebSockets::ConnectionOptions options;
+		options.reconnectMinDelayMs = 100;
+		options.reconnectMaxDelayMs = 500;
+		options.pingIntervalSeconds = 0;
+		options.connectTimeoutSeconds = 5;
+
+		const std::string url = fmt::format("ws://127.0.0.1:{}/selftest", port);
+		const uint64_t generation = generation_;
+
+		connection_id_ = WebSockets::Get().Connect(url,
+			[this, generation](std::string message, bool binary) { OnMessage(generation, message, binary); },
+			[this, generation](bool connected) { OnStateChanged(generation, connected); },
+			options);
+
+		if (connection_id_ == 0)
+		{
+			Finish("the connection could not be opened");
+			return "WebSocket self-test failed to open a connection";
+		}
+
+		return fmt::format("WebSocket self-test started against {}, the result is written to the log", url);
+	}
+
+	void WebSocketsSelfTest::OnStateChanged(uint64_t generation, bool connected)
+	{
+		if (!running_ || generation != generation_)
+			return;
+
+		if (connected && stage_ == Stage::Connecting)
+		{
+			stage_ = Stage::Echo;
+			WebSockets::Get().Send(connection_id_, GetTextPayload());
+			WebSockets::Get().Send(connection_id_, GetBinaryPayload(), true);
+		}
+		else if (!connected && stage_ == Stage::Dropped)
+		{
+			dropped_at_ = Clock::now();
+		}
+		else if (connected && stage_ == Stage::Dropped)
+		{
+			stage_ = Stage::Reconnected;
+			reconnect_ms_ = std::chrono::duration<double, std::milli>(Clock::now() - dropped_at_).count();
+			WebSockets::Get().Send(connection_id_, GetTextPayload());
+		}
+		else if (!connected)
+		{
+			Finish("the connection was lost unexpectedly");
+		}
+	}
+
+	void WebSocketsSelfTest::OnMessage(uint64_t generation, const std::string& message, bool binary)
+	{
+		if (!running_ || generation != generation_)
+			return;
+
+		const std::string& expected = binary ? GetBinaryPayload() : GetTextPayload();
+		if (message != expected)
+		{
+			Finish(fmt::format("{} echo of {} bytes does not match", binary ? "binary" : "text", message.size()));
+			return;
+		}
+
+		++echoes_;
+
+		if (stage_ == Stage::Echo && echoes_ == 2)
+		{
+			stage_ = Stage::Dropped;
+			WebSockets::Get().Send(connection_id_, DropCommand);
+		}
+		else if (stage_ == Stage::Reconnected)
+		{
+			Finish({});
+		}
+	}
+
+	void WebSocketsSelfTest::Tick()
+	{
+		if (running_ && Clock::now() - started_at_ > SelfTestTimeout)
+			Finish("timed out");
+	}
+
+	void WebSocketsSelfTest::Finish(const std::string& failure)
+	{
+		running_ = false;
+		game_api->GetCommands()->RemoveOnTickCallback("WebSocketsSelfTest");
+
+		if (connection_id_ != 0)
+			WebSockets::Get().Close(connection_id_);
+
+		StopServer();
+
+		const double seconds = std::chrono::duration<double>(Clock::now() - started_at_).count();
+
+		last_report_.clear();
+		if (failure.empty())
+		{
+			last_report_.push_back(fmt::format("WebSocket self-test passed in {:.2f}s: {} echoes, reconnected after {:.0f}ms",
+				seconds, echoes_, reconnect_ms_));
+		}
+		else
+		{
+			last_report_.push_back(fmt::format("WebSocket self-test failed after {:.2f}s: {}", seconds, failure));
+		}
+
+		for (const std::string& line : last_report_)
+		{
+			Log::GetLog()->info(line);
+		}
+	}
+
+	void WebSocketsSelfTest::StopServer()
+	{
+		if (!server_)
+			return;
+
+		// Stopping joins the acceptor and connection threads, keep that off the game thread
+		std::thread([server = std::shared_ptr<Poco::Net::HTTPServer>(std::move(server_))] {
+			server->stopAll(true);
+		}).detach();
+	}
+} // namespace API
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Poco::Net
+{
+	class HTTPServer;
+}
+
+namespace API
+{
+	/**
+	 * \brief Checks the WebSocket client against a loopback echo server.
+	 *
+	 * Goes through the public WebSockets API, so callbacks arrive from the regular `WebSocketsUpdate` tick. A text
+	 * and a large binary message have to come back unchanged, then the server drops the connection and the client
+	 * has to reconnect and echo once more. Runs one check at a time.
+	 */
+	class WebSocketsSelfTest
+	{
+	public:
+		static WebSocketsSelfTest& Get();
+
+		WebSocketsSelfTest(const WebSocketsSelfTest&) = delete;
+		WebSocketsSelfTest(WebSocketsSelfTest&&) = delete;
+		WebSocketsSelfTest& operator=(const WebSocketsSelfTest&) = delete;
+		WebSocketsSelfTest& operator=(WebSocketsSelfTest&&) = delete;
+
+		/**
+		 * \brief Starts the echo server and connects to it
+		 * \return Status message for the issuer of the command
+		 */
+		std::string Start();
+
+		bool IsRunning() const { return running_; }
+
+		/**
+		 * \brief Report of the last finished run, empty if none finished yet
+		 */
+		const std::vector<std::string>& GetLastReport() const { return last_report_; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		enum class Stage
+		{
+			Connecting,
+			Echo,
+			Dropped,
+			Reconnected
+		};
+
+		WebSocketsSelfTest() = default;
+		~WebSocketsSelfTest();
+
+		void OnStateChanged(uint64_t generation, bool connected);
+		void OnMessage(uint64_t generation, const std::string& message, bool binary);
+		void Tick();
+		void Finish(const std::string& failure);
+		void StopServer();
+
+		std::unique_ptr<Poco::Net::HTTPServer> server_;
+		bool running_{false};
+		uint64_t generation_{0};
+		uint64_t connection_id_{0};
+		Stage stage_{Stage::Connecting};
+		int echoes_{0};
+		Clock::time_point started_at_{};
+		Clock::time_point dropped_at_{};
+		double reconnect_ms_{0.0};
+
+		std::vector<std::string> last_report_;
+	};
+} // namespace API
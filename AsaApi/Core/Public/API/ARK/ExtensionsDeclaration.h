@@ -19,6 +19,14 @@ struct ActorExtensions
     */
     bool IsA(UClass* SomeBase);
 
+    /**
+    * \brief Returns if the actor is a T or a subclass of T, T::StaticClass() is resolved once per type.
+    * \tparam T The native base class to check against.
+    * \return true if the actor is a T or a subclass of T.
+    */
+    template <class T>
+    bool IsA();
+
     /**
     * \brief Returns the actor's location in world space.
     * \return The actor's location in world space.
@@ -17,10 +17,7 @@ FORCEINLINE FVector ActorExtensions::GetActorForwardVector()
     return FVector(0, 0, 0);
 }
 
-FORCEINLINE bool ActorExtensions::IsA(UClass* SomeBase)
-{
-    return static_cast<AActor*>(this)->ClassPrivateField()->IsChildOf(SomeBase);
-}
+// ActorExtensions::IsA is defined at the end of ArkApiUtils.h, it needs the complete IApiUtils
 
 FORCEINLINE FVector ActorExtensions::GetLocation()
 {
@@ -1,5 +1,6 @@
 #pragma once
 #include "..\Base.h"
+#include "..\Helpers\StringKernels.h"
 
 enum class ESocketType
 {
@@ -1361,8 +1362,7 @@ struct FStringHash
 {
 	std::size_t operator()(const FString& str) const
 	{
-		const std::string stdString(TCHAR_TO_UTF8(*str));
-		return std::hash<std::string>{}(stdString);
+		return AsaApi::StringKernels::Hash(*str, str.Len());
 	}
 };
 
@@ -1370,7 +1370,26 @@ struct FStringEqual
 {
 	bool operator()(const FString& lhs, const FString& rhs) const
 	{
-		return lhs.Equals(rhs);
+		return lhs.Len() == rhs.Len() && AsaApi::StringKernels::Equals(*lhs, *rhs, lhs.Len());
+	}
+};
+
+/**
+ * \brief Hash and equality for maps that look up FStrings ignoring the case of ASCII letters, like ESearchCase::IgnoreCase
+ */
+struct FStringHashIgnoreCase
+{
+	std::size_t operator()(const FString& str) const
+	{
+		return AsaApi::StringKernels::HashIgnoreCase(*str, str.Len());
+	}
+};
+
+struct FStringEqualIgnoreCase
+{
+	bool operator()(const FString& lhs, const FString& rhs) const
+	{
+		return lhs.Len() == rhs.Len() && AsaApi::StringKernels::EqualsIgnoreCase(*lhs, *rhs, lhs.Len());
 	}
 };
 
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ASA_TARGET_AVX2
+#else
+#define ASA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/**
+ * \brief Hashing and comparison of UTF-16 character buffers without conversions or allocations.
+ *
+ * Case insensitive variants only fold ASCII letters, the same C locale semantics FString uses for
+ * ESearchCase::IgnoreCase, so every character, ASCII or not, is handled inside the vector lanes. The hash of a
+ * string and the case insensitive hash of its lower case form are equal.
+ */
+namespace AsaApi::StringKernels
+{
+	namespace Detail
+	{
+		static_assert(sizeof(wchar_t) == 2, "Kernels work on UTF-16 code units");
+
+		inline bool HasAvx2()
+		{
+			static const bool has_avx2 = []
+			{
+#ifdef _MSC_VER
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] < 7)
+					return false;
+
+				__cpuid(info, 1);
+				const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+				__cpuidex(info, 7, 0);
+				return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+				return __builtin_cpu_supports("avx2") != 0;
+#endif
+			}();
+
+			return has_avx2;
+		}
+
+		inline wchar_t FoldChar(wchar_t c)
+		{
+			return static_cast<wchar_t>(c + ((static_cast<uint32_t>(c) - 'A' < 26u) << 5));
+		}
+
+		// Lanes above 0x7FFF compare as negative and are left alone, like every other non ASCII letter
+		inline __m128i Fold(__m128i chars)
+		{
+			const __m128i upper = _mm_and_si128(_mm_cmpgt_epi16(chars, _mm_set1_epi16('A' - 1)),
+				_mm_cmplt_epi16(chars, _mm_set1_epi16('Z' + 1)));
+			return _mm_add_epi16(chars, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+		}
+
+		ASA_TARGET_AVX2 inline __m256i Fold(__m256i chars)
+		{
+			const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi16(chars, _mm256_set1_epi16('A' - 1)),
+				_mm256_cmpgt_epi16(_mm256_set1_epi16('Z' + 1), chars));
+			return _mm256_add_epi16(chars, _mm256_and_si256(upper, _mm256_set1_epi16(0x20)));
+		}
+
+		inline uint64_t Mix(uint64_t hash, uint64_t value)
+		{
+			hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+			return hash ^ (hash >> 29);
+		}
+
+		inline uint64_t Finalize(uint64_t hash, size_t length)
+		{
+			hash ^= length;
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ull;
+			return hash ^ (hash >> 33);
+		}
+
+		template <bool IgnoreCase>
+		uint64_t Hash(const wchar_t* data, size_t length)
+		{
+			uint64_t hash = 0x84222325CBF29CE4ull;
+
+			size_t index = 0;
+			for (; index + 8 <= length; index += 8)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+				if constexpr (IgnoreCase)
+					block = Fold(block);
+
+				hash = Mix(hash, static_cast<uint64_t>(_mm_cvtsi128_si64(block)));
+				hash = Mix(hash, static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(block, block))));
+			}
+
+			if (index < length)
+			{
+				wchar_t tail[8] = {};
+				for (size_t i = 0; index + i < length; ++i)
+					tail[i] = IgnoreCase ? FoldChar(data[index + i]) : data[index + i];
+
+				uint64_t words[2];
+				std::memcpy(words, tail, sizeof(words));
+				hash = Mix(hash, words[0]);
+				hash = Mix(hash, words[1]);
+			}
+
+			return Finalize(hash, length);
+		}
+
+		ASA_TARGET_AVX2 inline bool EqualsIgnoreCaseAvx2(const wchar_t* a, const wchar_t* b, size_t length, size_t& index)
+		{
+			for (; index + 16 <= length; index += 16)
+			{
+				const __m256i lhs = Fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + index)));
+				const __m256i rhs = Fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + index)));
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(lhs, rhs)) != -1)
+					return false;
+			}
+
+			return true;
+		}
+	} // namespace Detail
+
+	/**
+	 * \brief Hashes `length` characters, the terminator is not read
+	 */
+	inline uint64_t Hash(const wchar_t* data, size_t length)
+	{
+		return Detail::Hash<false>(data, length);
+	}
+
+	/**
+	 * \brief Hash that is equal for strings that only differ in the case of ASCII letters
+	 */
+	inline uint64_t HashIgnoreCase(const wchar_t* data, size_t length)
+	{
+		return Detail::Hash<true>(data, length);
+	}
+
+	inline bool Equals(const wchar_t* a, const wchar_t* b, size_t length)
+	{
+		return std::memcmp(a, b, length * sizeof(wchar_t)) == 0;
+	}
+
+	/**
+	 * \brief Compares `length` characters of both buffers, ASCII letters are compared case insensitively
+	 */
+	inline bool EqualsIgnoreCase(const wchar_t* a, const wchar_t* b, size_t length)
+	{
+		size_t index = 0;
+
+		if (length >= 16 && Detail::HasAvx2() && !Detail::EqualsIgnoreCaseAvx2(a, b, length, index))
+			return false;
+
+		for (; index + 8 <= length; index += 8)
+		{
+			const __m128i lhs = Detail::Fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + index)));
+			const __m128i rhs = Detail::Fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + index)));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(lhs, rhs)) != 0xFFFF)
+				return false;
+		}
+
+		for (; index < length; ++index)
+		{
+			if (Detail::FoldChar(a[index]) != Detail::FoldChar(b[index]))
+				return false;
+		}
+
+		return true;
+	}
+} // namespace AsaApi::StringKernels
+
+#undef ASA_TARGET_AVX2
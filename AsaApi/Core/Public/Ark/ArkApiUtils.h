@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <optional>
 
 #include <API/ARK/Ark.h>
@@ -17,6 +18,25 @@ namespace AsaApi
 		float y = 0.f;
 	};
 
+	/**
+	 * \brief One octree query of a GetAllActorsInRange batch
+	 */
+	struct ActorsInRangeQuery
+	{
+		FVector location;
+		float radius = 0.f;
+		EServerOctreeGroup::Type group = EServerOctreeGroup::ALL_SPATIAL;
+
+		// Owned by the caller and emptied before it is filled, reuse it between ticks to keep its allocation
+		TArray<AActor*>* actors = nullptr;
+
+		// Optional, these actors are left out of the result
+		const TArray<AActor*>* ignores = nullptr;
+	};
+
+	class IApiUtils;
+	ARK_API IApiUtils& APIENTRY GetApiUtils();
+
 	class ARK_API IApiUtils
 	{
 	public:
@@ -157,21 +177,7 @@ namespace AsaApi
 		 */
 		FORCEINLINE AShooterPlayerController* FindPlayerFromPlatformName(const FString& steam_name) const
 		{
-			AShooterPlayerController* result = nullptr;
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				const FString current_name = player_controller->PlayerStateField()->PlayerNamePrivateField();
-				if (current_name == steam_name)
-				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-
-					result = shooter_pc;
-					break;
-				}
-			}
-
-			return result;
+			return FindPlayerFromPlatformName_Internal(steam_name);
 		}
 
 		/**
@@ -200,21 +206,17 @@ namespace AsaApi
 			ESearchCase::Type search,
 			bool full_match) const
 		{
-			TArray<AShooterPlayerController*> found_players;
-			const auto& player_controllers = GetWorld()->PlayerControllerListField();
-			for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
-			{
-				auto* shooter_player = static_cast<AShooterPlayerController*>(player_controller.Get());
-				FString char_name = GetCharacterName(shooter_player);
+			return FindPlayersFromCharacterName_Internal(character_name, search, full_match);
+		}
 
-				if (!char_name.IsEmpty() && (full_match
-					? char_name.Equals(character_name, search)
-					: char_name.StartsWith(character_name, search)))
-				{
-					found_players.Add(shooter_player);
-				}
-			}
-			return found_players;
+		/**
+		* \brief Finds all online players of a tribe
+		* \param tribe_id Tribe ID, the player data ID for players without a tribe
+		* \return Array of AShooterPlayerController*
+		*/
+		FORCEINLINE TArray<AShooterPlayerController*> FindPlayersFromTribeID(int tribe_id) const
+		{
+			return FindPlayersFromTribeID_Internal(tribe_id);
 		}
 
 		/**
@@ -252,6 +254,16 @@ namespace AsaApi
 			return FindPlayerFromEOSID_Internal(eos_id);
 		}
 
+		/**
+		 * \brief Finds player from the given player data ID
+		 * \param player_id Player data ID
+		 * \return Pointer to AShooterPlayerController
+		 */
+		FORCEINLINE AShooterPlayerController* FindPlayerFromPlayerID(uint64 player_id) const
+		{
+			return FindPlayerFromPlayerID_Internal(player_id);
+		}
+
 		/**
 		 * \brief Spawns an item drop
 		 * \param blueprint Item simplified BP
@@ -273,7 +285,7 @@ namespace AsaApi
 			FString bpFstr(blueprint);
 
 			TSubclassOf<UPrimalItem> archetype;
-			archetype.uClass = UVictoryCore::BPLoadClass(bpFstr);
+			archetype.uClass = LoadClass(bpFstr);
 
 			UPrimalItem* item = UPrimalItem::AddNewItem(archetype, nullptr, false, false, item_quality, false, amount, force_blueprint, 0, false, nullptr, 0, 0, 0, true, false, false);
 
@@ -319,7 +331,7 @@ namespace AsaApi
 			}
 
 			AActor* actor = player->SpawnActor(&blueprint, 100, 0, 0, true);
-			if (actor != nullptr && actor->IsA(APrimalDinoCharacter::GetPrivateStaticClass()))
+			if (actor != nullptr && actor->IsA<APrimalDinoCharacter>())
 			{
 				auto* dino = static_cast<APrimalDinoCharacter*>(actor);
 
@@ -541,15 +553,9 @@ namespace AsaApi
 			GetShooterGameMode()->GetSteamIDStringForPlayerID(&eos_id, player_id);
 			if (eos_id.IsEmpty())
 			{
-				const auto& player_controllers = GetWorld()->PlayerControllerListField();
-				for (TWeakObjectPtr<APlayerController> player_controller : player_controllers)
+				if (AShooterPlayerController* shooter_pc = FindPlayerFromPlayerID(player_id))
 				{
-					auto* shooter_pc = static_cast<AShooterPlayerController*>(player_controller.Get());
-					if (shooter_pc != nullptr && shooter_pc->LinkedPlayerIDField() == player_id)
-					{
-						shooter_pc->GetUniqueNetIdAsString(&eos_id);
-						break;
-					}
+					shooter_pc->GetUniqueNetIdAsString(&eos_id);
 				}
 
 				if (!eos_id.IsEmpty())
@@ -561,40 +567,151 @@ namespace AsaApi
 			return eos_id;
 		}
 
+		/**
+		 * \brief Returns the class of a blueprint path. Classes are loaded once and cached until they are garbage collected.
+		 * \param blueprint Blueprint'<path>' or any path UVictoryCore::BPLoadClass accepts
+		 * \return The class, nullptr if it could not be loaded
+		 */
+		static FORCEINLINE UClass* LoadClass(const FString& blueprint)
+		{
+			return GetApiUtils().LoadClass_Internal(blueprint);
+		}
+
+		/**
+		 * \brief Loads classes ahead of their first use, e.g. the items of a shop config. Call it from the game thread.
+		 * \return Number of classes that were loaded, the others are logged
+		 */
+		FORCEINLINE int PreloadClasses(const TArray<FString>& blueprints)
+		{
+			return PreloadClasses_Internal(blueprints);
+		}
+
+		/**
+		 * \brief Starts keeping the live actors of a class and its subclasses, read them with GetTrackedActors.
+		 * Nothing is hooked until a plugin tracks a class. Game thread only, tracking ends when the plugin unloads.
+		 */
+		FORCEINLINE void TrackActors(UClass* the_class)
+		{
+			TrackActors_Internal(the_class);
+		}
+
+		/**
+		 * \brief Stops tracking a class for this plugin
+		 */
+		FORCEINLINE void UntrackActors(UClass* the_class)
+		{
+			UntrackActors_Internal(the_class);
+		}
+
+		/**
+		 * \brief Fills actors with the live actors of a tracked class without scanning the world
+		 * \return False if the class is not tracked, use TrackActors first
+		 */
+		FORCEINLINE bool GetTrackedActors(UClass* the_class, TArray<AActor*>& actors)
+		{
+			return GetTrackedActors_Internal(the_class, actors);
+		}
+
+		/**
+		 * \brief Fills objects with every object of a class in GUObjectArray, scanned in parallel chunks.
+		 * Game thread only, garbage collection cannot run while the game thread waits for the workers.
+		 * \param the_class Searched class
+		 * \param objects Receives the objects in object array order
+		 * \param include_subclasses Also return objects of derived classes
+		 */
+		FORCEINLINE void GetObjectsOfClass(UClass* the_class, TArray<UObject*>& objects, bool include_subclasses = true)
+		{
+			GetObjectsOfClass_Internal(the_class, objects, include_subclasses);
+		}
+
 		/**
 		 * \brief Returns blueprint path from any UObject
 		 */
 		static FORCEINLINE FString GetBlueprint(UObjectBase* object)
 		{
 			if (object != nullptr && object->ClassPrivateField() != nullptr)
-			{
-				FString path_name = GetClassBlueprint(object->ClassPrivateField());
-				return path_name.Replace(L"Default__", L"", ESearchCase::CaseSensitive);
-			}
-				
+				return GetApiUtils().GetObjectBlueprint_Internal(object->ClassPrivateField());
+
 			return FString("");
 		}
 
 		/**
-		 * \brief Returns blueprint path from any UClass
+		 * \brief Returns blueprint path from any UClass. Paths are cached per class until the class is garbage collected.
 		 */
 		static FORCEINLINE FString GetClassBlueprint(UClass* the_class)
 		{
 			if (!the_class)
 				return FString("");
 
-			FString path;
-			TSubclassOf<UObject> subclass;
-			subclass.uClass = the_class;
-			FString* result = UVictoryCore::ClassToStringReference(&path, &subclass);
+			return GetApiUtils().GetClassBlueprint_Internal(the_class);
+		}
 
-			if (!result || result->IsEmpty())
-				return FString("");
+		/**
+		 * \brief Returns the blueprint path of a UClass as FName, NAME_None if it has none. Compare these instead of strings.
+		 */
+		static FORCEINLINE FName GetClassBlueprintName(UClass* the_class)
+		{
+			if (!the_class)
+				return FName();
 
-			if (result->EndsWith(TEXT("_C")))
-				return FString::Printf(TEXT("Blueprint'%s'"), *result->LeftChop(2));
-			else
-				return FString::Printf(TEXT("Blueprint'%s'"), **result);
+			return GetApiUtils().GetClassBlueprintName_Internal(the_class);
+		}
+
+		/**
+		 * \brief Returns true if GetBlueprint(object) equals blueprint. Compares class pointers once the blueprint was seen.
+		 * \param object Any UObject
+		 * \param blueprint Blueprint'<path>' as returned by GetBlueprint
+		 */
+		static FORCEINLINE bool IsBlueprint(UObjectBase* object, const FString& blueprint)
+		{
+			if (object == nullptr || object->ClassPrivateField() == nullptr)
+				return false;
+
+			return GetApiUtils().IsBlueprint_Internal(object->ClassPrivateField(), blueprint);
+		}
+
+		/**
+		 * \brief Returns true if the_class is base or derives from it. Superclass chains are cached per class,
+		 * so once both classes were seen this is an index compare instead of a walk through the game.
+		 */
+		static FORCEINLINE bool IsChildOf(UClass* the_class, UClass* base)
+		{
+			return GetApiUtils().IsChildOf_Internal(the_class, base);
+		}
+
+		/**
+		 * \brief Returns true if the object is of class base or a subclass of it
+		 */
+		static FORCEINLINE bool IsA(UObjectBase* object, UClass* base)
+		{
+			if (object == nullptr)
+				return false;
+
+			return GetApiUtils().IsChildOf_Internal(object->ClassPrivateField(), base);
+		}
+
+		/**
+		 * \brief Returns T::StaticClass() resolved once per type instead of on every call.
+		 * The cached class is checked against GUObjectArray and resolved again if it was garbage collected.
+		 */
+		template <class T>
+		static FORCEINLINE UClass* GetStaticClass()
+		{
+			static std::atomic<UClass*> cached_class{nullptr};
+
+			UClass* the_class = cached_class.load(std::memory_order_acquire);
+			if (the_class == nullptr || !GetApiUtils().IsClassCached_Internal(the_class))
+			{
+				if constexpr (requires { T::StaticClass(); })
+					the_class = T::StaticClass();
+				else
+					the_class = T::GetPrivateStaticClass();
+
+				GetApiUtils().CacheClass_Internal(the_class);
+				cached_class.store(the_class, std::memory_order_release);
+			}
+
+			return the_class;
 		}
 
 
@@ -689,6 +806,16 @@ namespace AsaApi
 			return out_actors;
 		}
 
+		/**
+		* \brief Runs a batch of range queries, each one fills its own caller owned buffer.
+		* Identical queries (location, radius and group) call the octree once per tick, the others get a copy of the
+		* first result without the actors destroyed since. The overloads above always query the octree. Game thread only.
+		*/
+		FORCEINLINE void GetAllActorsInRange(TArray<ActorsInRangeQuery>& queries)
+		{
+			GetAllActorsInRange_Internal(queries.GetData(), queries.Num());
+		}
+
 		/**
 		* \brief Converts FVector into coords that are displayed when you view the ingame map
 		*/
@@ -702,7 +829,7 @@ namespace AsaApi
 			if (p_world_settings->CurrentMinimapDataField().uClass)
 				minimap_data = static_cast<UMinimapData*>(p_world_settings->CurrentMinimapDataField().uClass->GetDefaultObject(true));
 			else
-				minimap_data = static_cast<UMinimapData*>(UVictoryCore::BPLoadClass("Blueprint'/Game/ASA/Minimap/Core/MinimapData_Base.MinimapData_Base'")->GetDefaultObject(true));
+				minimap_data = static_cast<UMinimapData*>(LoadClass(L"Blueprint'/Game/ASA/Minimap/Core/MinimapData_Base.MinimapData_Base'")->GetDefaultObject(true));
 
 			FMapData* map_data = nullptr;
 			if (minimap_data->MinimapDataField().Num() == 1)
@@ -745,11 +872,11 @@ namespace AsaApi
 
 			if (target)
 			{
-				if (killer && !killer->IsLocalController() && killer->IsA(AShooterPlayerController::GetPrivateStaticClass())
+				if (killer && !killer->IsLocalController() && IsA(killer, GetStaticClass<AShooterPlayerController>())
 					&& (!tribe_check || (tribe_check && target->TargetingTeamField() != killer->TargetingTeamField())))
 					eos_id = GetEOSIDFromController(static_cast<AShooterPlayerController*>(killer));
 				else if (damage_causer && (!tribe_check || (tribe_check && target->TargetingTeamField() != damage_causer->TargetingTeamField()))
-					&& damage_causer->IsA(APrimalStructureExplosive::StaticClass()))
+					&& damage_causer->IsA<APrimalStructureExplosive>())
 				{
 					APrimalStructureExplosive* explosive = static_cast<APrimalStructureExplosive*>(damage_causer);
 					eos_id = GetEOSIDForPlayerID(explosive->ConstructorPlayerDataIDField());
@@ -855,7 +982,38 @@ namespace AsaApi
 		virtual AShooterPlayerController* FindPlayerFromEOSID_Internal(const FString& eos_id) const = 0;
 		virtual std::shared_ptr<MessagingManager> GetMessagingManagerInternal(const FString& forPlugin) const = 0;
 		virtual void SetMessagingManagerInternal(const FString& forPlugin, std::shared_ptr<MessagingManager> manager) = 0;
+		// Appended so plugins built against the previous interface keep their vtable layout
+		virtual AShooterPlayerController* FindPlayerFromPlayerID_Internal(uint64 player_id) const = 0;
+		virtual AShooterPlayerController* FindPlayerFromPlatformName_Internal(const FString& platform_name) const = 0;
+		virtual TArray<AShooterPlayerController*> FindPlayersFromCharacterName_Internal(const FString& character_name,
+			ESearchCase::Type search, bool full_match) const = 0;
+		virtual TArray<AShooterPlayerController*> FindPlayersFromTribeID_Internal(int tribe_id) const = 0;
+		virtual FString GetClassBlueprint_Internal(UClass* the_class) = 0;
+		virtual FString GetObjectBlueprint_Internal(UClass* the_class) = 0;
+		virtual FName GetClassBlueprintName_Internal(UClass* the_class) = 0;
+		virtual bool IsBlueprint_Internal(UClass* the_class, const FString& blueprint) = 0;
+		virtual UClass* LoadClass_Internal(const FString& blueprint) = 0;
+		virtual int PreloadClasses_Internal(const TArray<FString>& blueprints) = 0;
+		virtual void TrackActors_Internal(UClass* the_class) = 0;
+		virtual void UntrackActors_Internal(UClass* the_class) = 0;
+		virtual bool GetTrackedActors_Internal(UClass* the_class, TArray<AActor*>& actors) = 0;
+		virtual void GetObjectsOfClass_Internal(UClass* the_class, TArray<UObject*>& objects, bool include_subclasses) = 0;
+		virtual bool IsChildOf_Internal(UClass* the_class, UClass* base) = 0;
+		virtual bool IsClassCached_Internal(UClass* the_class) = 0;
+		virtual void CacheClass_Internal(UClass* the_class) = 0;
+		virtual void GetAllActorsInRange_Internal(ActorsInRangeQuery* queries, int count) = 0;
 	};
 
 	ARK_API IApiUtils& APIENTRY GetApiUtils();
 } // namespace AsaApi
+
+FORCEINLINE bool ActorExtensions::IsA(UClass* SomeBase)
+{
+	return AsaApi::IApiUtils::IsChildOf(static_cast<AActor*>(this)->ClassPrivateField(), SomeBase);
+}
+
+template <class T>
+FORCEINLINE bool ActorExtensions::IsA()
+{
+	return IsA(AsaApi::IApiUtils::GetStaticClass<T>());
+}
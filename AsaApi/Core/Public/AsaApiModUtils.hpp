@@ -22,7 +22,7 @@ namespace AsaApiModUtils
 			if (!Singleton)
 			{
 				TArray<AActor*> actors;
-				UClass* SingletonClass = UVictoryCore::BPLoadClass("Blueprint'/AsaApiUtils/ApiUtilsSingleton.ApiUtilsSingleton'");
+				UClass* SingletonClass = AsaApi::IApiUtils::LoadClass(L"Blueprint'/AsaApiUtils/ApiUtilsSingleton.ApiUtilsSingleton'");
 				if (SingletonClass != nullptr)
 				{
 					UGameplayStatics::GetAllActorsOfClass(AsaApi::GetApiUtils().GetWorld(), SingletonClass, &actors);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <windows.h>
+#include "API/Base.h"
+#include "json.hpp"
+
+namespace API
+{
+	/**
+	 * \brief Parses the API config.json and the plugin configs once and shares them as immutable snapshots.
+	 *
+	 * Both files are watched after the API finished loading. An edited file is parsed again once it was quiet
+	 * for a moment and subscribers are notified on the game thread. A file that fails to parse keeps its last
+	 * good snapshot.
+	 */
+	class ConfigService
+	{
+	public:
+		using Snapshot = std::shared_ptr<const nlohmann::json>;
+		using Callback = std::function<void(const Snapshot&)>;
+
+		ARK_API static ConfigService& Get();
+
+		ConfigService();
+		~ConfigService();
+
+		ConfigService(const ConfigService&) = delete;
+		ConfigService(ConfigService&&) = delete;
+		ConfigService& operator=(const ConfigService&) = delete;
+		ConfigService& operator=(ConfigService&&) = delete;
+
+		/**
+		 * \brief Returns the API config.json, an empty object if the file does not exist
+		 */
+		ARK_API Snapshot GetConfig();
+
+		/**
+		 * \brief Returns the `settings` object of the API config.json, an empty object if it is missing
+		 */
+		ARK_API static const nlohmann::json& GetSettings(const Snapshot& config);
+
+		/**
+		 * \brief Returns Plugins/<plugin_name>/config.json, an empty object if the file does not exist
+		 */
+		ARK_API Snapshot GetPluginConfig(const std::string& plugin_name);
+
+		/**
+		 * \brief Calls `callback` on the game thread with the new snapshot whenever the file changed
+		 * \param plugin_name Plugin whose config is observed, empty for the API config.json
+		 * \param callback Change callback
+		 * \return Subscription id, 0 if the caller's plugin module could not be resolved
+		 */
+		ARK_API uint64_t Subscribe(const std::string& plugin_name, const Callback& callback);
+
+		ARK_API void Unsubscribe(uint64_t subscriptionId);
+
+		/**
+		 * \brief Drops all subscriptions of the specified plugin module. Called by the plugin manager before `FreeLibrary`.
+		 * \param pluginModule Handle of the plugin being unloaded.
+		 */
+		ARK_API void UnsubscribeModule(HMODULE pluginModule);
+
+		/**
+		 * \brief Starts watching the config files and reports a config.json that failed to parse before the logger was up
+		 */
+		void Start();
+
+	private:
+		class impl;
+		std::unique_ptr<impl> pimpl;
+	};
+} // namespace API
@@ -2,9 +2,28 @@
 
 #include "../API/Base.h"
 #include "Logger/spdlog/spdlog.h"
+#include "Logger/RateLimit.h"
 
 ARK_API std::vector<spdlog::sink_ptr>& APIENTRY GetLogSinks();
 
+/**
+ * \brief Makes the level of a logger adjustable at runtime. Applies the level configured for its name, if any.
+ */
+ARK_API void APIENTRY RegisterLogger(spdlog::logger* logger);
+ARK_API void APIENTRY UnregisterLogger(spdlog::logger* logger);
+
+/**
+ * \brief Changes the level of every registered logger called `name`, or of all loggers if `name` is "*".
+ * The level is remembered and applied to loggers registered later under that name.
+ * \return False if no registered logger matched
+ */
+ARK_API bool APIENTRY SetLoggerLevel(const std::string& name, spdlog::level::level_enum level);
+
+/**
+ * \brief Returns name and level of every registered logger
+ */
+ARK_API std::vector<std::pair<std::string, spdlog::level::level_enum>> APIENTRY GetLoggerLevels();
+
 class Log
 {
 public:
@@ -28,15 +47,91 @@ public:
 	{
 		auto& sinks = GetLogSinks();
 
+		if (logger_)
+			UnregisterLogger(logger_.get());
+
 		logger_ = std::make_shared<spdlog::logger>(plugin_name, begin(sinks), end(sinks));
 
 		logger_->set_pattern("%D %R [%n][%l] %v");
 		logger_->flush_on(spdlog::level::info);
+
+		RegisterLogger(logger_.get());
+	}
+
+	/**
+	 * \brief Parses a level name like "debug" or "warn"
+	 * \return False if the name is unknown
+	 */
+	static bool ParseLevel(const std::string& name, spdlog::level::level_enum& level)
+	{
+		static const char* names[] = SPDLOG_LEVEL_NAMES;
+
+		for (int i = spdlog::level::trace; i <= spdlog::level::off; ++i)
+		{
+			if (name == names[i])
+			{
+				level = static_cast<spdlog::level::level_enum>(i);
+				return true;
+			}
+		}
+
+		if (name == "warn" || name == "err")
+		{
+			level = name == "warn" ? spdlog::level::warn : spdlog::level::err;
+			return true;
+		}
+
+		return false;
 	}
 
 private:
 	Log() = default;
-	~Log() = default;
+
+	~Log()
+	{
+		if (logger_)
+			UnregisterLogger(logger_.get());
+	}
 
 	std::shared_ptr<spdlog::logger> logger_;
 };
+
+/**
+ * \brief Lowest level compiled into the LOG_* macros, numbered like spdlog::level (0 trace, 1 debug, 2 info).
+ * Release builds drop trace and debug statements unless it is defined lower before including this header.
+ */
+#ifndef LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define LOG_ACTIVE_LEVEL 2
+#else
+#define LOG_ACTIVE_LEVEL 0
+#endif
+#endif
+
+/**
+ * \brief Logs to the logger of this module. Arguments are only evaluated if the level is enabled for it.
+ */
+#define LOG_AT(level, ...) \
+	do \
+	{ \
+		if (Log::GetLog()->should_log(level)) \
+			Log::GetLog()->log(level, __VA_ARGS__); \
+	} \
+	while (false)
+
+#if LOG_ACTIVE_LEVEL <= 0
+#define LOG_TRACE(...) LOG_AT(spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if LOG_ACTIVE_LEVEL <= 1
+#define LOG_DEBUG(...) LOG_AT(spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#define LOG_INFO(...) LOG_AT(spdlog::level::info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(spdlog::level::warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(spdlog::level::err, __VA_ARGS__)
+#define LOG_CRITICAL(...) LOG_AT(spdlog::level::critical, __VA_ARGS__)
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "../API/Base.h"
+#include "Logger/spdlog/spdlog.h"
+
+class LogRateLimiter;
+
+/**
+ * \brief Adds a limiter to the ones whose suppressed lines are summarized once per second
+ */
+ARK_API void APIENTRY RegisterLogRateLimiter(LogRateLimiter* limiter);
+ARK_API void APIENTRY UnregisterLogRateLimiter(LogRateLimiter* limiter);
+
+/**
+ * \brief Logs a summary for every registered limiter whose window ended with suppressed lines.
+ * Called by the API once per second.
+ */
+ARK_API void APIENTRY ReportSuppressedLogLines();
+
+/**
+ * \brief Per call site state of the LOG_LIMITED macros.
+ *
+ * At most `burst` lines pass per `window`, everything above is counted instead of formatted. Suppressed lines
+ * are summarized once the window is over, or before the next line that passes, whichever comes first.
+ */
+class LogRateLimiter
+{
+public:
+	/**
+	 * \param key Named in the summary of suppressed lines, set by KeyedLogRateLimiter
+	 */
+	LogRateLimiter(spdlog::logger& logger, spdlog::level::level_enum level, std::chrono::milliseconds window,
+		uint32_t burst, std::string key = {})
+		: window_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(window).count()),
+		  burst_(burst),
+		  level_(level),
+		  key_(std::move(key)),
+		  logger_(&logger)
+	{
+		RegisterLogRateLimiter(this);
+	}
+
+	~LogRateLimiter()
+	{
+		UnregisterLogRateLimiter(this);
+	}
+
+	LogRateLimiter(const LogRateLimiter&) = delete;
+	LogRateLimiter& operator=(const LogRateLimiter&) = delete;
+
+	/**
+	 * \brief Counts a line and decides if it may be logged
+	 */
+	bool Allow()
+	{
+		const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+
+		int64_t window_start = window_start_.load(std::memory_order_relaxed);
+		if (now - window_start >= window_ && window_start_.compare_exchange_strong(window_start, now, std::memory_order_relaxed))
+			passed_.store(0, std::memory_order_relaxed);
+
+		if (passed_.fetch_add(1, std::memory_order_relaxed) < burst_)
+			return true;
+
+		suppressed_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	/**
+	 * \brief Returns the number of lines suppressed since the last call
+	 */
+	uint32_t TakeSuppressed()
+	{
+		return suppressed_.exchange(0, std::memory_order_relaxed);
+	}
+
+	std::chrono::milliseconds GetWindow() const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::duration(window_));
+	}
+
+	template <typename... Args>
+	void Emit(spdlog::logger& logger, spdlog::level::level_enum level, const char* fmt, const Args&... args)
+	{
+		// The module may have created a new logger since the limiter was constructed
+		logger_.store(&logger, std::memory_order_relaxed);
+		fmt_.store(fmt, std::memory_order_relaxed);
+
+		if (const uint32_t suppressed = TakeSuppressed(); suppressed > 0)
+			logger.log(level, "The following message was suppressed {} times (limit {} per {}ms)", suppressed, burst_,
+				GetWindow().count());
+
+		logger.log(level, fmt, args...);
+	}
+
+	/**
+	 * \brief Logs how many lines were suppressed if the window they fell into is over
+	 */
+	void ReportSuppressed()
+	{
+		spdlog::logger* logger = logger_.load(std::memory_order_relaxed);
+		const char* fmt = fmt_.load(std::memory_order_relaxed);
+		if (logger == nullptr || fmt == nullptr || suppressed_.load(std::memory_order_relaxed) == 0)
+			return;
+
+		const int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+		if (now - window_start_.load(std::memory_order_relaxed) < window_)
+			return;
+
+		if (const uint32_t suppressed = TakeSuppressed(); suppressed > 0)
+		{
+			if (key_.empty())
+				logger->log(level_, "Suppressed {} more lines of \"{}\" (limit {} per {}ms)", suppressed, fmt, burst_,
+					GetWindow().count());
+			else
+				logger->log(level_, "Suppressed {} more lines of \"{}\" for {} (limit {} per {}ms)", suppressed, fmt, key_,
+					burst_, GetWindow().count());
+		}
+	}
+
+	/**
+	 * \brief Stops reporting through `logger`, called when it is unregistered
+	 */
+	void ForgetLogger(spdlog::logger* logger)
+	{
+		spdlog::logger* expected = logger;
+		logger_.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed);
+	}
+
+private:
+	const int64_t window_;
+	const uint32_t burst_;
+	const spdlog::level::level_enum level_;
+	const std::string key_;
+
+	std::atomic<spdlog::logger*> logger_;
+	std::atomic<const char*> fmt_{nullptr};
+
+	std::atomic<int64_t> window_start_{std::numeric_limits<int64_t>::min() / 2};
+	std::atomic<uint32_t> passed_{0};
+	std::atomic<uint32_t> suppressed_{0};
+};
+
+/**
+ * \brief One LogRateLimiter per key at a call site, so a repeating key cannot hide the lines of the others.
+ *
+ * Keys past `MaxKeys` share one limiter, a call site fed unbounded keys cannot grow without limit.
+ */
+class KeyedLogRateLimiter
+{
+public:
+	static constexpr size_t MaxKeys = 256;
+
+	KeyedLogRateLimiter(spdlog::logger& logger, spdlog::level::level_enum level, std::chrono::milliseconds window,
+		uint32_t burst)
+		: logger_(logger),
+		  level_(level),
+		  window_(window),
+		  burst_(burst),
+		  overflow_(logger, level, window, burst, "other keys")
+	{
+	}
+
+	KeyedLogRateLimiter(const KeyedLogRateLimiter&) = delete;
+	KeyedLogRateLimiter& operator=(const KeyedLogRateLimiter&) = delete;
+
+	LogRateLimiter& For(const std::string& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (const auto iter = limiters_.find(key); iter != limiters_.end())
+			return *iter->second;
+
+		if (limiters_.size() >= MaxKeys)
+			return overflow_;
+
+		return *limiters_.emplace(key, std::make_unique<LogRateLimiter>(logger_, level_, window_, burst_, key)).first->second;
+	}
+
+private:
+	spdlog::logger& logger_;
+	const spdlog::level::level_enum level_;
+	const std::chrono::milliseconds window_;
+	const uint32_t burst_;
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, std::unique_ptr<LogRateLimiter>> limiters_;
+	LogRateLimiter overflow_;
+};
+
+/**
+ * \brief Logs at most `burst` lines per `window_ms` from this call site. Arguments of suppressed lines are
+ * neither evaluated nor formatted, their count is logged once the window is over.
+ *
+ * Example: LOG_LIMITED_EX(Log::GetLog(), spdlog::level::warn, 10000, 5, "Tick failed for {}", name);
+ */
+#define LOG_LIMITED_EX(logger, level, window_ms, burst, ...) \
+	do \
+	{ \
+		static LogRateLimiter log_rate_limiter_{*(logger), level, std::chrono::milliseconds(window_ms), burst}; \
+		if ((logger)->should_log(level) && log_rate_limiter_.Allow()) \
+			log_rate_limiter_.Emit(*(logger), level, __VA_ARGS__); \
+	} \
+	while (false)
+
+/**
+ * \brief LOG_LIMITED_EX with a limit of 5 lines per 10 seconds
+ */
+#define LOG_LIMITED(logger, level, ...) LOG_LIMITED_EX(logger, level, 10000, 5, __VA_ARGS__)
+
+/**
+ * \brief LOG_LIMITED_EX with a separate limit per `key`, e.g. the host or function a failure is about.
+ * The key is only evaluated if `level` is enabled.
+ *
+ * Example: LOG_LIMITED_KEYED_EX(Log::GetLog(), spdlog::level::err, host, 10000, 5, "Request to {} failed", host);
+ */
+#define LOG_LIMITED_KEYED_EX(logger, level, key, window_ms, burst, ...) \
+	do \
+	{ \
+		static KeyedLogRateLimiter log_rate_limiters_{*(logger), level, std::chrono::milliseconds(window_ms), burst}; \
+		if ((logger)->should_log(level)) \
+		{ \
+			LogRateLimiter& log_rate_limiter_ = log_rate_limiters_.For(key); \
+			if (log_rate_limiter_.Allow()) \
+				log_rate_limiter_.Emit(*(logger), level, __VA_ARGS__); \
+		} \
+	} \
+	while (false)
+
+/**
+ * \brief LOG_LIMITED_KEYED_EX with a limit of 5 lines per 10 seconds for each key
+ */
+#define LOG_LIMITED_KEYED(logger, level, key, ...) LOG_LIMITED_KEYED_EX(logger, level, key, 10000, 5, __VA_ARGS__)
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "Logger/Logger.h"
+
+namespace API
+{
+	/**
+	 * \brief Typed key/value attached to a structured log record
+	 */
+	struct LogField
+	{
+		using Value = std::variant<std::nullptr_t, bool, int64_t, uint64_t, double, std::string>;
+
+		template <typename T>
+		LogField(std::string field_key, T&& field_value)
+			: key(std::move(field_key)),
+			  value(ToValue(std::forward<T>(field_value)))
+		{
+		}
+
+		std::string key;
+		Value value;
+
+	private:
+		template <typename T>
+		static Value ToValue(T&& field_value)
+		{
+			using Type = std::decay_t<T>;
+
+			if constexpr (std::is_same_v<Type, bool> || std::is_same_v<Type, std::nullptr_t>)
+				return field_value;
+			else if constexpr (std::is_enum_v<Type>)
+				return static_cast<int64_t>(field_value);
+			else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+				return static_cast<int64_t>(field_value);
+			else if constexpr (std::is_integral_v<Type>)
+				return static_cast<uint64_t>(field_value);
+			else if constexpr (std::is_floating_point_v<Type>)
+				return static_cast<double>(field_value);
+			else if constexpr (requires { field_value.ToStringUTF8(); })
+				return field_value.ToStringUTF8(); // FString
+			else
+				return std::string(std::string_view(field_value));
+		}
+	};
+} // namespace API
+
+/**
+ * \brief Logs `message` with `fields` through `logger`. Text sinks receive the fields appended as key=value,
+ * the structured sink (settings.Logging.Structured) writes them as typed JSON values.
+ */
+ARK_API void APIENTRY LogStructured(spdlog::logger* logger, spdlog::level::level_enum level, const std::string& message,
+                                    const std::vector<API::LogField>& fields);
+
+/**
+ * \brief Logs a structured record to the logger of this module, fields are only built if the level is enabled.
+ *
+ * Example: LOG_EVENT(spdlog::level::info, "Player joined", {"eos_id", eos_id}, {"tribe", tribe_id});
+ */
+#define LOG_EVENT(level, message, ...) \
+	do \
+	{ \
+		if (Log::GetLog()->should_log(level)) \
+			LogStructured(Log::GetLog().get(), level, message, {__VA_ARGS__}); \
+	} \
+	while (false)
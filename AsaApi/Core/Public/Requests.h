@@ -39,6 +39,19 @@ namespace API
 		 */
 		ARK_API void UnregisterCallbacksForModule(HMODULE pluginModule);
 
+		/**
+		 * \brief Returns one line per contacted host with its request, failure, retry and circuit breaker counters.
+		 *
+		 * Requests are shaped per host according to `settings.HttpTrafficShaping` in config.json: a token bucket
+		 * limits the request rate, idempotent methods (GET, DELETE) are retried with jittered exponential backoff
+		 * and a circuit breaker fails requests fast with status 503 while the host keeps failing.
+		 *
+		 * Requests advertise `Accept-Encoding: gzip, deflate` and compressed bodies are decoded on the worker thread.
+		 * Passing an own `Accept-Encoding` header (e.g. `Accept-Encoding: identity`) opts out, the body is then returned as sent.
+		 * The statistics include how many responses arrived compressed and the average compression ratio.
+		 */
+		ARK_API std::vector<std::string> GetHostStatistics();
+
 		/**
 		 * \brief Creates an async GET Request that runs in another thread but calls the callback from the main thread
 		 * \param request URL
@@ -280,7 +293,7 @@ namespace API
 
 		/**
 		 * \brief Creates an sync GET Request that should NOT be called from the main game thread to avoid player timeout
-		 * issues
+		 * issues. It is never queued behind the host rate limit or retried, a rate limited host fails it with 429 right away.
 		 * \param request URL
 		 * \param included headers
 		 * \return Populated `RequestSyncData` describing the response.
@@ -290,7 +303,7 @@ namespace API
 
 		/**
 		 * \brief Creates an sync GET Request that should NOT be called from the main game thread to avoid player timeout
-		 * issues
+		 * issues. It is never queued behind the host rate limit or retried, a rate limited host fails it with 429 right away.
 		 * \param request URL
 		 * \param included headers
 		 * \param included connectionTimeout in seconds (0 = default)
@@ -304,6 +317,7 @@ namespace API
 
 		/**
 		 * \brief Downloads a file from the specified URL to the specified local path, blocking the calling thread until completion.
+		 * Uses parallel, resumable range requests where the server supports them, see the overload below.
 		 * \param url URL of the file to download
 		 * \param localPath Local file path to save the downloaded file to
 		 * \param headers Optional HTTP headers to include in the download request
@@ -311,6 +325,21 @@ namespace API
 		 */
 		static bool DownloadFile(const std::string& url, const std::string& localPath, std::vector<std::string> headers = {});
 
+		/**
+		 * \brief Downloads a file using parallel HTTP range requests, blocking the calling thread until completion.
+		 *
+		 * Segments are kept next to the target as `<localPath>.part.<n>` until the file is complete, a failed or
+		 * interrupted download resumes from them on the next call. Servers without range support are streamed in one piece.
+		 * \param url URL of the file to download
+		 * \param localPath Local file path to save the downloaded file to
+		 * \param headers HTTP headers to include in every request
+		 * \param expectedSha256 Hex SHA-256 the file must match, empty to skip verification
+		 * \param maxSegments Maximum number of parallel connections
+		 * \return `true` if the file was downloaded (and verified), `false` otherwise
+		 */
+		ARK_API static bool DownloadFile(const std::string& url, const std::string& localPath, std::vector<std::string> headers,
+			const std::string& expectedSha256, int maxSegments = 4);
+
 		// ! --- DEPRECATED ---
 		// NOTE: These functions are deprecated. They are intentionally left in place to maintain backward compatibility 
 		// with existing deployed plugins. Do not use in new code. Consider migrating existing usage to the non-deprecated versions.
@@ -122,6 +122,7 @@ namespace API
 
 			FString identifier;
 			FString moduleName;
+			HMODULE module{nullptr};
 			std::chrono::time_point<std::chrono::system_clock> next_time;
 			std::function<void()> callback;
 			bool exec_once;
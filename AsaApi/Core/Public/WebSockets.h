@@ -0,0 +1,77 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <windows.h>
+#include "API/Base.h"
+
+namespace API
+{
+	class WebSockets
+	{
+	public:
+		ARK_API static WebSockets& Get();
+
+		WebSockets();
+		~WebSockets();
+
+		WebSockets(const WebSockets&) = delete;
+		WebSockets(WebSockets&&) = delete;
+		WebSockets& operator=(const WebSockets&) = delete;
+		WebSockets& operator=(WebSockets&&) = delete;
+
+		struct ConnectionOptions
+		{
+			std::vector<std::string> headers;
+			bool reconnect = true;
+			int reconnectMinDelayMs = 1000;
+			int reconnectMaxDelayMs = 30000;
+			int pingIntervalSeconds = 30; // 0 = no keep-alive pings
+			int connectTimeoutSeconds = 10;
+		};
+
+		/**
+		 * \brief Opens a persistent WebSocket connection that is serviced by a network worker of the API.
+		 *
+		 * Callbacks are invoked on the game thread from the tick, the same way HTTP request callbacks are.
+		 * Lost connections are re-established with jittered exponential backoff unless `options.reconnect` is false.
+		 * \param url ws:// or wss:// URL
+		 * \param onMessage Called for every complete message with its payload and whether it was a binary frame
+		 * \param onStateChanged Called with `true` whenever the connection is (re)established and `false` when it is lost
+		 * \param options Headers for the handshake, reconnect and keep-alive settings
+		 * \return Connection id, 0 if the caller's plugin module could not be resolved
+		 */
+		ARK_API uint64_t Connect(const std::string& url,
+			const std::function<void(std::string, bool)>& onMessage,
+			const std::function<void(bool)>& onStateChanged,
+			const ConnectionOptions& options = {});
+
+		/**
+		 * \brief Queues a message for sending
+		 * \param connectionId Id returned by `Connect`
+		 * \param message Payload
+		 * \param binary Send as binary frame instead of text
+		 * \return `false` if the connection is unknown, currently not established or its send queue is full
+		 */
+		ARK_API bool Send(uint64_t connectionId, const std::string& message, bool binary = false);
+
+		ARK_API bool IsConnected(uint64_t connectionId);
+
+		/**
+		 * \brief Closes the connection, no callback of it is invoked afterwards
+		 */
+		ARK_API void Close(uint64_t connectionId);
+
+		/**
+		 * \brief Closes all connections opened by the specified plugin module. Called by the plugin manager before `FreeLibrary`.
+		 * \param pluginModule Handle of the plugin being unloaded.
+		 */
+		ARK_API void CloseConnectionsForModule(HMODULE pluginModule);
+
+	private:
+		class impl;
+		std::unique_ptr<impl> pimpl;
+	};
+} // namespace API
@@ -1,11 +1,14 @@
 #include "Logger/Logger.h"
 #include "..\Private\IBaseApi.h"
 #include "..\Private\Ark\ArkBaseApi.h"
+#include "..\Private\Logging\AsyncLogSink.h"
+#include "..\Private\Logging\FlightRecorderSink.h"
+#include "..\Private\Logging\LogRetention.h"
 
 #include "Tools.h"
+#include "ConfigService.h"
 #include <filesystem>
 #include <tlhelp32.h>
-#include <fstream>
 #include <json.hpp>
 
 DWORD GetParentProcessId()
@@ -37,16 +40,13 @@ DWORD GetParentProcessId()
 
 bool AttachToParent()
 {
-	const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-	std::ifstream file{ config_path };
-	if (!file.is_open())
-		return false;
+	const auto config = API::ConfigService::Get().GetConfig();
 
-	nlohmann::json config;
-	file >> config;
-	file.close();
+	// A missing config.json gives an empty snapshot, the server then gets a console of its own
+	if (config->empty())
+		return false;
 
-	return config["settings"].value("AttachToParent", true);
+	return API::ConfigService::GetSettings(config).value("AttachToParent", true);
 }
 
 void OpenConsole()
@@ -63,44 +63,21 @@ void OpenConsole()
 	SetConsoleOutputCP(CP_UTF8);
 }
 
-void DeleteOldLogFiles()
+void StartLogRetention()
 {
-	const std::string config_path = AsaApi::Tools::GetCurrentDir() + "/config.json";
-	std::ifstream file{ config_path };
-	if (!file.is_open())
+	const auto config = API::ConfigService::Get().GetConfig();
+	const nlohmann::json delete_old_logs = API::ConfigService::GetSettings(config).value("DeleteOldLogs", nlohmann::json::object());
+	if (delete_old_logs.value("Enable", false) == false)
 		return;
 
-	nlohmann::json config;
-	file >> config;
-	file.close();
-
-	if (config.value("settings", nlohmann::json::object()).value("DeleteOldLogs", nlohmann::json::object()).value("Enable", false) == false)
-		return;
+	API::LogRetention::Settings settings;
+	settings.max_age = std::chrono::hours(delete_old_logs.value("MaxAge", 24));
+	settings.max_total_size = delete_old_logs.value("MaxTotalSizeMB", 0ull) * 1024 * 1024;
+	settings.compress = delete_old_logs.value("Compress", true);
+	settings.compress_after = std::chrono::minutes(delete_old_logs.value("CompressAfterMinutes", 60));
+	settings.interval = std::chrono::minutes((std::max)(delete_old_logs.value("IntervalMinutes", 60), 1));
 
-	const std::string folderPath = API::Tools::GetCurrentDir() + "\\logs";
-	const int maxAgeInSeconds = config.value("DeleteOldLogs", nlohmann::json::object()).value("MaxAge", 24) * 3600;
-
-	for (const auto& entry : std::filesystem::directory_iterator(folderPath)) {
-		if (entry.is_regular_file()) {
-			try
-			{
-				std::filesystem::file_time_type file_time = std::filesystem::last_write_time(entry);
-				auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(file_time - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
-				std::time_t tt = std::chrono::system_clock::to_time_t(sctp);
-
-				if (std::difftime(std::time(nullptr), tt) > maxAgeInSeconds) {
-					Log::GetLog()->info("Deleted log file: {}", entry.path().filename().string());
-
-					std::filesystem::remove(entry.path());
-				}
-			}
-			catch (std::exception& error)
-			{
-				Log::GetLog()->error("Error: {}", error.what());
-				break;
-			}
-		}
-	}
+	API::LogRetention::Get().Start(API::Tools::GetCurrentDir() + "\\logs", settings);
 }
 
 void Init()
@@ -118,7 +95,11 @@ void Init()
 
 	Log::Get().Init("API");
 
-	DeleteOldLogFiles();
+	// Before the retention thread starts, a crashed session may be older than the maximum age
+	for (const auto& recovered : API::FlightRecorderSink::RecoverCrashedSessions(current_dir + "/logs"))
+		Log::GetLog()->warn("Previous session did not shut down cleanly, recovered its last log records to {}", recovered.filename().string());
+
+	StartLogRetention();
 
 	API::game_api = std::make_unique<API::ArkBaseApi>();
 	API::game_api->Init();
@@ -134,6 +115,9 @@ BOOL APIENTRY DllMain(HMODULE, DWORD ul_reason_for_call, LPVOID)
 	if (ul_reason_for_call == DLL_PROCESS_DETACH)
 	{
 		API::game_api.release();
+
+		// Other threads are already gone at process exit, write what the async logger still holds
+		API::AsyncLogSink::DrainInstalled();
 	}
 
 	return 1;
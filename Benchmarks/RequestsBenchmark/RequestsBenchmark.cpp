@@ -0,0 +1,428 @@
+#define WIN32_LEAN_AND_MEAN
+
+#include "RequestsBenchmark.h"
+
+#include <API/ARK/Ark.h>
+#include <Requests.h>
+#include <Logger/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include "Poco/StreamCopier.h"
+#include "Poco/Crypto/EVPPKey.h"
+#include "Poco/Crypto/X509Certificate.h"
+#include "Poco/Net/Context.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/SecureServerSocket.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SSLManager.h"
+
+#include <Windows.h>
+#include <TlHelp32.h>
+#include <Psapi.h>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		// Give up on outstanding requests after this long, the report then covers what arrived
+		constexpr auto BenchmarkTimeout = std::chrono::seconds(120);
+		constexpr float SampleIntervalSeconds = 0.25f;
+
+		const std::string& GetPayload()
+		{
+			static const std::string payload = [] {
+				std::string json = "{\"items\":[";
+				for (int i = 0; i < 64; ++i)
+				{
+					json += fmt::format("{}{{\"id\":{},\"name\":\"PrimalItemResource_Benchmark_{}\",\"quantity\":{}}}",
+						i == 0 ? "" : ",", i, i, i * 7);
+				}
+				return json + "]}";
+			}();
+
+			return payload;
+		}
+
+		class BenchmarkRequestHandler : public Poco::Net::HTTPRequestHandler
+		{
+		public:
+			void handleRequest(Poco::Net::HTTPServerRequest& request, Poco::Net::HTTPServerResponse& response) override
+			{
+				// POST bodies are echoed back, everything else gets a fixed JSON document
+				std::string body;
+				if (request.getMethod() == Poco::Net::HTTPRequest::HTTP_POST)
+					Poco::StreamCopier::copyToString(request.stream(), body);
+				else
+					body = GetPayload();
+
+				response.setContentType("application/json");
+				response.setContentLength(body.size());
+				response.send() << body;
+			}
+		};
+
+		class BenchmarkHandlerFactory : public Poco::Net::HTTPRequestHandlerFactory
+		{
+		public:
+			Poco::Net::HTTPRequestHandler* createRequestHandler(const Poco::Net::HTTPServerRequest& /*request*/) override
+			{
+				return new BenchmarkRequestHandler;
+			}
+		};
+
+		/**
+		 * \brief Server context with a self-signed certificate for 127.0.0.1, valid for a day
+		 */
+		Poco::Net::Context::Ptr CreateServerContext()
+		{
+			EVP_PKEY* key = EVP_RSA_gen(2048);
+			X509* certificate = X509_new();
+			if (key == nullptr || certificate == nullptr)
+			{
+				EVP_PKEY_free(key);
+				X509_free(certificate);
+				throw Poco::Exception("Creating the certificate failed");
+			}
+
+			X509_set_version(certificate, 2);
+			ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+			X509_gmtime_adj(X509_getm_notBefore(certificate), -60);
+			X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+			X509_set_pubkey(certificate, key);
+
+			X509_NAME* name = X509_get_subject_name(certificate);
+			X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+			X509_set_issuer_name(certificate, name);
+			X509_sign(certificate, key, EVP_sha256());
+
+			Poco::Net::Context::Params params;
+			params.verificationMode = Poco::Net::Context::VERIFY_NONE;
+
+			Poco::Net::Context::Ptr context = new Poco::Net::Context(Poco::Net::Context::TLS_SERVER_USE, params);
+
+			// X509Certificate takes the certificate over, EVPPKey copies the key
+			context->useCertificate(Poco::Crypto::X509Certificate(certificate));
+			context->usePrivateKey(Poco::Crypto::EVPPKey(key));
+			EVP_PKEY_free(key);
+
+			return context;
+		}
+
+		uint32_t CountProcessThreads()
+		{
+			const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+			if (snapshot == INVALID_HANDLE_VALUE)
+				return 0;
+
+			const DWORD process_id = GetCurrentProcessId();
+			uint32_t count = 0;
+
+			THREADENTRY32 entry{};
+			entry.dwSize = sizeof(entry);
+			if (Thread32First(snapshot, &entry))
+			{
+				do
+				{
+					if (entry.th32OwnerProcessID == process_id)
+						++count;
+				} while (Thread32Next(snapshot, &entry));
+			}
+
+			CloseHandle(snapshot);
+			return count;
+		}
+
+		uint64_t GetPrivateBytes()
+		{
+			PROCESS_MEMORY_COUNTERS_EX counters{};
+			if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters)))
+				return 0;
+
+			return counters.PrivateUsage;
+		}
+
+		double Percentile(const std::vector<double>& sorted, double percentile)
+		{
+			if (sorted.empty())
+				return 0.0;
+
+			const size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size())));
+			return sorted[(std::min)(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+		}
+
+		const char* ModeName(RequestsBenchmark::Mode mode)
+		{
+			switch (mode)
+			{
+			case RequestsBenchmark::Mode::Post:
+				return "POST";
+			case RequestsBenchmark::Mode::Mixed:
+				return "GET/POST";
+			default:
+				return "GET";
+			}
+		}
+
+		const char* TransportName(RequestsBenchmark::Transport transport)
+		{
+			return transport == RequestsBenchmark::Transport::Https ? "HTTPS" : "HTTP";
+		}
+	} // namespace
+
+	RequestsBenchmark& RequestsBenchmark::Get()
+	{
+		static RequestsBenchmark instance;
+		return instance;
+	}
+
+	RequestsBenchmark::~RequestsBenchmark()
+	{
+		if (server_)
+			server_->stopAll(true);
+
+		if (server_stopper_.joinable())
+			server_stopper_.join();
+	}
+
+	std::string RequestsBenchmark::Start(int request_count, Mode mode, Transport transport, const Thresholds& thresholds,
+		std::function<void(const Result&)> on_finished)
+	{
+		if (running_)
+			return fmt::format("Benchmark already running ({}/{} requests done)", completed_, request_count_);
+
+		Poco::UInt16 port = 0;
+		try
+		{
+			const Poco::Net::SocketAddress address("127.0.0.1", 0);
+
+			Poco::Net::ServerSocket socket;
+			if (transport == Transport::Https)
+			{
+				Poco::Net::initializeSSL();
+				socket = Poco::Net::SecureServerSocket(address, 64, CreateServerContext());
+			}
+			else
+			{
+				socket = Poco::Net::ServerSocket(address);
+			}
+
+			port = socket.address().port();
+
+			Poco::Net::HTTPServerParams::Ptr params = new Poco::Net::HTTPServerParams;
+			params->setMaxThreads(64);
+			params->setMaxQueued(request_count);
+
+			server_ = std::make_unique<Poco::Net::HTTPServer>(new BenchmarkHandlerFactory, socket, params);
+			server_->start();
+		}
+		catch (const Poco::Exception& exc)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, exc.displayText());
+			server_.reset();
+			return "Failed to start local benchmark server - " + exc.displayText();
+		}
+
+		++generation_;
+		running_ = true;
+		mode_ = mode;
+		transport_ = transport;
+		thresholds_ = thresholds;
+		on_finished_ = std::move(on_finished);
+		request_count_ = request_count;
+		completed_ = 0;
+		failed_ = 0;
+		latencies_ms_.clear();
+		latencies_ms_.reserve(request_count);
+		sample_accumulator_ = 0.0f;
+
+		baseline_threads_ = peak_threads_ = CountProcessThreads();
+		baseline_private_bytes_ = peak_private_bytes_ = GetPrivateBytes();
+
+		AsaApi::GetCommands().AddOnTickCallback("RequestsBenchmark", [this](float delta_seconds) { Tick(delta_seconds); });
+
+		const std::string url = fmt::format("{}://127.0.0.1:{}/benchmark", transport == Transport::Https ? "https" : "http", port);
+		const std::string post_data = GetPayload();
+		const uint64_t generation = generation_;
+
+		started_at_ = Clock::now();
+
+		for (int i = 0; i < request_count; ++i)
+		{
+			const bool post = mode == Mode::Post || (mode == Mode::Mixed && i % 2 == 1);
+			const Clock::time_point sent = Clock::now();
+			bool dispatched;
+
+			if (post)
+			{
+				dispatched = API::Requests::Get().CreatePostRequest(url,
+					[this, generation, sent](bool success, std::string, std::unordered_map<std::string, std::string>) {
+						OnResponse(generation, sent, success);
+					}, post_data, "application/json");
+			}
+			else
+			{
+				dispatched = API::Requests::Get().CreateGetRequest(url,
+					[this, generation, sent](bool success, std::string) {
+						OnResponse(generation, sent, success);
+					});
+			}
+
+			if (!dispatched)
+			{
+				++failed_;
+				++completed_;
+			}
+		}
+
+		if (completed_ >= request_count_)
+		{
+			Finish(false);
+			return "Benchmark failed to dispatch any request";
+		}
+
+		return fmt::format("Benchmark started: {} {} requests against {}, the report is written to the log",
+			request_count, ModeName(mode), url);
+	}
+
+	void RequestsBenchmark::Stop()
+	{
+		if (!running_)
+			return;
+
+		running_ = false;
+		on_finished_ = nullptr;
+		AsaApi::GetCommands().RemoveOnTickCallback("RequestsBenchmark");
+		StopServer();
+
+		// The plugin is about to be unloaded, no thread may still run its code
+		if (server_stopper_.joinable())
+			server_stopper_.join();
+	}
+
+	void RequestsBenchmark::OnResponse(uint64_t generation, Clock::time_point sent, bool success)
+	{
+		// Stragglers of a run that already timed out
+		if (!running_ || generation != generation_)
+			return;
+
+		latencies_ms_.push_back(std::chrono::duration<double, std::milli>(Clock::now() - sent).count());
+		++completed_;
+		if (!success)
+			++failed_;
+
+		if (completed_ >= request_count_)
+			Finish(false);
+	}
+
+	void RequestsBenchmark::Tick(float delta_seconds)
+	{
+		if (!running_)
+			return;
+
+		sample_accumulator_ += delta_seconds;
+		if (sample_accumulator_ >= SampleIntervalSeconds)
+		{
+			sample_accumulator_ = 0.0f;
+			SampleProcess();
+		}
+
+		if (Clock::now() - started_at_ > BenchmarkTimeout)
+			Finish(true);
+	}
+
+	void RequestsBenchmark::SampleProcess()
+	{
+		peak_threads_ = (std::max)(peak_threads_, CountProcessThreads());
+		peak_private_bytes_ = (std::max)(peak_private_bytes_, GetPrivateBytes());
+	}
+
+	void RequestsBenchmark::Finish(bool timed_out)
+	{
+		SampleProcess();
+
+		running_ = false;
+		AsaApi::GetCommands().RemoveOnTickCallback("RequestsBenchmark");
+		StopServer();
+
+		const double seconds = std::chrono::duration<double>(Clock::now() - started_at_).count();
+		const double requests_per_second = seconds > 0.0 ? static_cast<double>(completed_) / seconds : 0.0;
+		const uint32_t added_threads = peak_threads_ - (std::min)(peak_threads_, baseline_threads_);
+
+		std::sort(latencies_ms_.begin(), latencies_ms_.end());
+		const double p99 = Percentile(latencies_ms_, 0.99);
+
+		Result result;
+		result.report.push_back(fmt::format("Requests benchmark ({} over {}): {}/{} completed, {} failed{}",
+			ModeName(mode_), TransportName(transport_), completed_, request_count_, failed_, timed_out ? ", timed out" : ""));
+		result.report.push_back(fmt::format("Throughput: {:.1f} req/s over {:.2f}s", requests_per_second, seconds));
+		result.report.push_back(fmt::format("Latency (dispatch to callback): p50 {:.1f}ms, p99 {:.1f}ms, max {:.1f}ms",
+			Percentile(latencies_ms_, 0.50), p99, latencies_ms_.empty() ? 0.0 : latencies_ms_.back()));
+		result.report.push_back(fmt::format("Threads: {} before, {} peak | Private memory: {:.1f}MB before, +{:.1f}MB peak",
+			baseline_threads_, peak_threads_, static_cast<double>(baseline_private_bytes_) / (1024.0 * 1024.0),
+			static_cast<double>(peak_private_bytes_ - (std::min)(peak_private_bytes_, baseline_private_bytes_)) / (1024.0 * 1024.0)));
+
+		if (timed_out)
+			result.violations.push_back(fmt::format("{} requests still outstanding after {}s", request_count_ - completed_,
+				std::chrono::duration_cast<std::chrono::seconds>(BenchmarkTimeout).count()));
+		if (failed_ > thresholds_.max_failed_requests)
+			result.violations.push_back(fmt::format("{} failed requests, at most {} allowed", failed_, thresholds_.max_failed_requests));
+		if (thresholds_.max_p99_latency_ms > 0.0 && p99 > thresholds_.max_p99_latency_ms)
+			result.violations.push_back(fmt::format("p99 latency {:.1f}ms above {:.1f}ms", p99, thresholds_.max_p99_latency_ms));
+		if (thresholds_.min_requests_per_second > 0.0 && requests_per_second < thresholds_.min_requests_per_second)
+			result.violations.push_back(fmt::format("throughput {:.1f} req/s below {:.1f} req/s", requests_per_second,
+				thresholds_.min_requests_per_second));
+		if (thresholds_.max_added_threads > 0 && added_threads > thresholds_.max_added_threads)
+			result.violations.push_back(fmt::format("{} threads added, at most {} allowed", added_threads, thresholds_.max_added_threads));
+
+		result.passed = result.violations.empty();
+
+		std::string verdict = result.passed ? "Result: PASS" : "Result: FAIL - ";
+		for (size_t i = 0; i < result.violations.size(); ++i)
+		{
+			verdict += (i > 0 ? ", " : "") + result.violations[i];
+		}
+		result.report.push_back(std::move(verdict));
+
+		for (const std::string& line : result.report)
+		{
+			Log::GetLog()->info(line);
+		}
+
+		if (!result.passed)
+			Log::GetLog()->error("Requests benchmark failed its thresholds");
+
+		latencies_ms_ = std::vector<double>();
+		last_result_ = std::move(result);
+
+		if (const auto on_finished = std::exchange(on_finished_, nullptr))
+			on_finished(last_result_);
+	}
+
+	void RequestsBenchmark::StopServer()
+	{
+		if (!server_)
+			return;
+
+		if (server_stopper_.joinable())
+			server_stopper_.join();
+
+		// Stopping joins the acceptor and connection threads, keep that off the game thread
+		server_stopper_ = std::thread([server = std::shared_ptr<Poco::Net::HTTPServer>(std::move(server_))] {
+			server->stopAll(true);
+		});
+	}
+} // namespace Benchmarks
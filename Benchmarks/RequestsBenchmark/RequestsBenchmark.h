@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Poco::Net
+{
+	class HTTPServer;
+}
+
+namespace Benchmarks
+{
+	/**
+	 * \brief Measures the Requests engine against a loopback HTTP or HTTPS server.
+	 *
+	 * All requests go through the public Requests API like any plugin's, callbacks are delivered by the regular
+	 * `RequestsUpdate` tick, so the numbers include the game thread drain. The HTTPS server uses a self-signed
+	 * certificate created for the run, the engine does not verify server certificates. Runs one benchmark at a time.
+	 */
+	class RequestsBenchmark
+	{
+	public:
+		enum class Mode
+		{
+			Get,
+			Post,
+			Mixed
+		};
+
+		enum class Transport
+		{
+			Http,
+			Https
+		};
+
+		/**
+		 * \brief Limits a run has to stay within, a zero limit is not checked
+		 */
+		struct Thresholds
+		{
+			int max_failed_requests{0};
+			double max_p99_latency_ms{0.0};
+			double min_requests_per_second{0.0};
+			uint32_t max_added_threads{0};
+		};
+
+		struct Result
+		{
+			bool passed{false};
+			std::vector<std::string> report;
+			std::vector<std::string> violations;
+		};
+
+		static RequestsBenchmark& Get();
+
+		RequestsBenchmark(const RequestsBenchmark&) = delete;
+		RequestsBenchmark(RequestsBenchmark&&) = delete;
+		RequestsBenchmark& operator=(const RequestsBenchmark&) = delete;
+		RequestsBenchmark& operator=(RequestsBenchmark&&) = delete;
+
+		/**
+		 * \brief Starts the local server and dispatches all requests at once
+		 * \param on_finished Called on the game thread with the result once all requests completed or timed out
+		 * \return Status message for the issuer of the command
+		 */
+		std::string Start(int request_count, Mode mode, Transport transport, const Thresholds& thresholds,
+			std::function<void(const Result&)> on_finished = {});
+
+		/**
+		 * \brief Abandons a running benchmark without a result, used when the plugin unloads
+		 */
+		void Stop();
+
+		bool IsRunning() const { return running_; }
+
+		/**
+		 * \brief Result of the last finished run, the report is empty if none finished yet
+		 */
+		const Result& GetLastResult() const { return last_result_; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		RequestsBenchmark() = default;
+		~RequestsBenchmark();
+
+		void OnResponse(uint64_t generation, Clock::time_point sent, bool success);
+		void Tick(float delta_seconds);
+		void SampleProcess();
+		void Finish(bool timed_out);
+		void StopServer();
+
+		std::unique_ptr<Poco::Net::HTTPServer> server_;
+		std::thread server_stopper_;
+		bool running_{false};
+		uint64_t generation_{0};
+		Mode mode_{Mode::Get};
+		Transport transport_{Transport::Http};
+		Thresholds thresholds_;
+		std::function<void(const Result&)> on_finished_;
+		int request_count_{0};
+		int completed_{0};
+		int failed_{0};
+		std::vector<double> latencies_ms_;
+		Clock::time_point started_at_{};
+		float sample_accumulator_{0.0f};
+
+		uint32_t baseline_threads_{0};
+		uint32_t peak_threads_{0};
+		uint64_t baseline_private_bytes_{0};
+		uint64_t peak_private_bytes_{0};
+
+		Result last_result_;
+	};
+} // namespace Benchmarks
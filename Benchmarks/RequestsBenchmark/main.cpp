@@ -0,0 +1,208 @@
+#define WIN32_LEAN_AND_MEAN
+
+#include "RequestsBenchmark.h"
+
+#include <API/ARK/Ark.h>
+#include <Logger/Logger.h>
+#include <Tools.h>
+
+#include <fstream>
+
+#include "json.hpp"
+
+// Standalone benchmark for the Requests engine, built as a plugin so the core DLL does not ship it.
+// Copy RequestsBenchmark.dll and config.json to ArkApi/Plugins/RequestsBenchmark/ on a test server. With
+// "RunOnStartup" enabled the configured run starts after BeginPlay, writes last_result.json next to the DLL and,
+// with "ExitWithResult", ends the server process with exit code 0 on PASS and 1 on FAIL for CI scripts.
+
+namespace
+{
+	using Benchmarks::RequestsBenchmark;
+
+	std::string GetPluginDir()
+	{
+		return AsaApi::Tools::GetCurrentDir() + "/ArkApi/Plugins/RequestsBenchmark";
+	}
+
+	nlohmann::json ReadConfig()
+	{
+		std::ifstream file(GetPluginDir() + "/config.json");
+		if (!file.is_open())
+			return nlohmann::json::object();
+
+		try
+		{
+			nlohmann::json config;
+			file >> config;
+			return config;
+		}
+		catch (const std::exception& error)
+		{
+			Log::GetLog()->warn("({}) {}", __FUNCTION__, error.what());
+			return nlohmann::json::object();
+		}
+	}
+
+	RequestsBenchmark::Thresholds ReadThresholds(const nlohmann::json& config)
+	{
+		const nlohmann::json thresholds = config.value("Thresholds", nlohmann::json::object());
+
+		RequestsBenchmark::Thresholds result;
+		result.max_failed_requests = thresholds.value("MaxFailedRequests", 0);
+		result.max_p99_latency_ms = thresholds.value("MaxP99LatencyMs", 1000.0);
+		result.min_requests_per_second = thresholds.value("MinRequestsPerSecond", 100.0);
+		result.max_added_threads = thresholds.value("MaxAddedThreads", 128u);
+		return result;
+	}
+
+	bool ParseMode(const std::string& name, RequestsBenchmark::Mode& mode)
+	{
+		if (_stricmp(name.c_str(), "get") == 0)
+			mode = RequestsBenchmark::Mode::Get;
+		else if (_stricmp(name.c_str(), "post") == 0)
+			mode = RequestsBenchmark::Mode::Post;
+		else if (_stricmp(name.c_str(), "mixed") == 0)
+			mode = RequestsBenchmark::Mode::Mixed;
+		else
+			return false;
+
+		return true;
+	}
+
+	bool ParseTransport(const std::string& name, RequestsBenchmark::Transport& transport)
+	{
+		if (_stricmp(name.c_str(), "http") == 0)
+			transport = RequestsBenchmark::Transport::Http;
+		else if (_stricmp(name.c_str(), "https") == 0)
+			transport = RequestsBenchmark::Transport::Https;
+		else
+			return false;
+
+		return true;
+	}
+
+	void WriteResult(const RequestsBenchmark::Result& result)
+	{
+		const nlohmann::json json = {
+			{"passed", result.passed},
+			{"report", result.report},
+			{"violations", result.violations}
+		};
+
+		std::ofstream file(GetPluginDir() + "/last_result.json", std::ios::trunc);
+		file << json.dump(4);
+	}
+
+	FString Benchmark(FString* cmd)
+	{
+		TArray<FString> parsed;
+		cmd->ParseIntoArray(parsed, L" ", true);
+
+		auto& benchmark = RequestsBenchmark::Get();
+
+		if (!parsed.IsValidIndex(1))
+		{
+			if (benchmark.IsRunning())
+				return L"Benchmark is running";
+
+			if (benchmark.GetLastResult().report.empty())
+				return L"Usage: requests.benchmark <count> [get|post|mixed] [http|https]";
+
+			std::string reply;
+			for (const std::string& line : benchmark.GetLastResult().report)
+			{
+				reply += line + "\n";
+			}
+
+			return FString(reply);
+		}
+
+		int count = 0;
+		try
+		{
+			count = std::stoi(parsed[1].ToString());
+		}
+		catch (const std::exception&)
+		{
+		}
+
+		if (count < 1 || count > 20000)
+			return L"Request count must be between 1 and 20000";
+
+		auto mode = RequestsBenchmark::Mode::Get;
+		auto transport = RequestsBenchmark::Transport::Http;
+		if ((parsed.IsValidIndex(2) && !ParseMode(parsed[2].ToString(), mode))
+			|| (parsed.IsValidIndex(3) && !ParseTransport(parsed[3].ToString(), transport)))
+		{
+			return L"Usage: requests.benchmark <count> [get|post|mixed] [http|https]";
+		}
+
+		const std::string reply = benchmark.Start(count, mode, transport, ReadThresholds(ReadConfig()), &WriteResult);
+		Log::GetLog()->info(reply);
+
+		return FString(reply);
+	}
+
+	void BenchmarkCmd(APlayerController* player_controller, FString* cmd, bool /*unused*/)
+	{
+		auto* shooter_controller = static_cast<AShooterPlayerController*>(player_controller);
+		AsaApi::GetApiUtils().SendServerMessage(shooter_controller, FColorList::Green, *Benchmark(cmd));
+	}
+
+	void BenchmarkRcon(RCONClientConnection* rcon_connection, RCONPacket* rcon_packet, UWorld* /*unused*/)
+	{
+		FString reply = Benchmark(&rcon_packet->Body);
+		rcon_connection->SendMessageW(rcon_packet->Id, 0, &reply);
+	}
+
+	void RunOnStartup()
+	{
+		const nlohmann::json config = ReadConfig();
+		const nlohmann::json startup = config.value("RunOnStartup", nlohmann::json::object());
+		if (!startup.value("Enable", false))
+			return;
+
+		auto mode = RequestsBenchmark::Mode::Mixed;
+		auto transport = RequestsBenchmark::Transport::Https;
+		const int count = startup.value("Requests", 2000);
+
+		if (count < 1 || !ParseMode(startup.value("Mode", "mixed"), mode)
+			|| !ParseTransport(startup.value("Transport", "https"), transport))
+		{
+			Log::GetLog()->error("Invalid RunOnStartup settings in config.json");
+			return;
+		}
+
+		const bool exit_with_result = startup.value("ExitWithResult", false);
+
+		const std::string reply = RequestsBenchmark::Get().Start(count, mode, transport, ReadThresholds(config),
+			[exit_with_result](const RequestsBenchmark::Result& result) {
+				WriteResult(result);
+
+				if (exit_with_result)
+					TerminateProcess(GetCurrentProcess(), result.passed ? 0 : 1);
+			});
+		Log::GetLog()->info(reply);
+	}
+} // namespace
+
+extern "C" __declspec(dllexport) void Plugin_Init()
+{
+	Log::Get().Init("RequestsBenchmark");
+
+	AsaApi::GetCommands().AddConsoleCommand("requests.benchmark", &BenchmarkCmd);
+	AsaApi::GetCommands().AddRconCommand("requests.benchmark", &BenchmarkRcon);
+}
+
+extern "C" __declspec(dllexport) void Plugin_InitPostBeginPlay()
+{
+	RunOnStartup();
+}
+
+extern "C" __declspec(dllexport) void Plugin_Unload()
+{
+	RequestsBenchmark::Get().Stop();
+
+	AsaApi::GetCommands().RemoveConsoleCommand("requests.benchmark");
+	AsaApi::GetCommands().RemoveRconCommand("requests.benchmark");
+}